@@ -0,0 +1,143 @@
+#include "WakaTimeCliManifest.h"
+
+#include <cctype>
+#include <cstdio>
+#include <vector>
+
+#include "WakaTimeConfig.h"
+
+// Splits "v1.98.0" into 1, 98, 0; stops at anything that is not a number or a dot, e.g. a "-rc" suffix
+static std::vector<long> SplitVersion(const std::string& Version)
+{
+	std::vector<long> Parts;
+	size_t Index = !Version.empty() && (Version[0] == 'v' || Version[0] == 'V') ? 1 : 0;
+
+	while (Index < Version.size() && std::isdigit(static_cast<unsigned char>(Version[Index])))
+	{
+		long Part = 0;
+		while (Index < Version.size() && std::isdigit(static_cast<unsigned char>(Version[Index])))
+		{
+			Part = Part * 10 + (Version[Index] - '0');
+			Index++;
+		}
+		Parts.push_back(Part);
+
+		if (Index >= Version.size() || Version[Index] != '.')
+		{
+			break;
+		}
+		Index++;
+	}
+
+	return Parts;
+}
+
+bool FWakaTimeCliManifest::Load(const std::string& Path, const std::string& ExeName)
+{
+	FWakaTimeConfig Config;
+	bool bLoaded = Config.Load(Path);
+
+	Version = Config.Get(ExeName, "version");
+	Checksum = Config.Get(ExeName, "checksum");
+	LastCheckTime = Config.GetDouble(ExeName, "last_checked", 0.0);
+	return bLoaded;
+}
+
+bool FWakaTimeCliManifest::Save(const std::string& Path, const std::string& ExeName) const
+{
+	FWakaTimeConfig Config;
+	Config.Load(Path);
+
+	char LastCheckText[32];
+	std::snprintf(LastCheckText, sizeof(LastCheckText), "%.0f", LastCheckTime);
+
+	Config.Set(ExeName, "version", Version);
+	Config.Set(ExeName, "checksum", Checksum);
+	Config.Set(ExeName, "last_checked", LastCheckText);
+	return Config.Save(Path);
+}
+
+bool FWakaTimeCliManifest::IsCheckDue(double Now, double IntervalSeconds) const
+{
+	// a check time in the future means the clock was changed; checking again is cheaper than trusting it
+	return Now - LastCheckTime >= IntervalSeconds || LastCheckTime > Now;
+}
+
+bool FWakaTimeCliManifest::IsNewerVersion(const std::string& Candidate, const std::string& Installed)
+{
+	std::vector<long> CandidateParts = SplitVersion(Candidate);
+	std::vector<long> InstalledParts = SplitVersion(Installed);
+
+	if (CandidateParts.empty())
+	{
+		return false;
+	}
+	if (InstalledParts.empty())
+	{
+		return true;
+	}
+
+	size_t NumParts = CandidateParts.size() > InstalledParts.size() ? CandidateParts.size() : InstalledParts.size();
+	for (size_t Index = 0; Index < NumParts; Index++)
+	{
+		long CandidatePart = Index < CandidateParts.size() ? CandidateParts[Index] : 0;
+		long InstalledPart = Index < InstalledParts.size() ? InstalledParts[Index] : 0;
+		if (CandidatePart != InstalledPart)
+		{
+			return CandidatePart > InstalledPart;
+		}
+	}
+	return false;
+}
+
+std::string FWakaTimeCliManifest::ParseReleaseTag(const std::string& ReleaseJson)
+{
+	static const std::string Key = "\"tag_name\"";
+
+	// an escaped key is part of some other string, e.g. the release notes quoting an older release
+	size_t KeyStart = ReleaseJson.find(Key);
+	while (KeyStart != std::string::npos && KeyStart > 0 && ReleaseJson[KeyStart - 1] == '\\')
+	{
+		KeyStart = ReleaseJson.find(Key, KeyStart + 1);
+	}
+	if (KeyStart == std::string::npos)
+	{
+		return "";
+	}
+
+	size_t Colon = ReleaseJson.find_first_not_of(" \t\r\n", KeyStart + Key.size());
+	size_t ValueStart = Colon == std::string::npos || ReleaseJson[Colon] != ':'
+		                    ? std::string::npos
+		                    : ReleaseJson.find_first_not_of(" \t\r\n", Colon + 1);
+	if (ValueStart == std::string::npos || ReleaseJson[ValueStart] != '"')
+	{
+		return "";
+	}
+
+	size_t ValueEnd = ReleaseJson.find('"', ValueStart + 1);
+	if (ValueEnd == std::string::npos)
+	{
+		return "";
+	}
+
+	// release tags contain no escapes; a value that does is not a tag this plugin could download
+	std::string Tag = ReleaseJson.substr(ValueStart + 1, ValueEnd - ValueStart - 1);
+	if (Tag.find('\\') != std::string::npos)
+	{
+		return "";
+	}
+	return SplitVersion(Tag).empty() ? "" : Tag;
+}
+
+std::string FWakaTimeCliManifest::ParseVersionOutput(const std::string& Output)
+{
+	size_t Start = Output.find_first_not_of(" \t\r\n");
+	if (Start == std::string::npos)
+	{
+		return "";
+	}
+
+	size_t End = Output.find_first_of(" \t\r\n", Start);
+	std::string Version = Output.substr(Start, End == std::string::npos ? std::string::npos : End - Start);
+	return SplitVersion(Version).empty() ? "" : Version;
+}
@@ -0,0 +1,137 @@
+#include "WakaTimeCommand.h"
+
+#include <cstdio>
+
+#include "WakaTimeJson.h"
+
+std::string FWakaTimeCommand::ToCommandLine() const
+{
+	std::string CommandLine;
+	for (const std::string& Argument : Arguments)
+	{
+		if (!CommandLine.empty())
+		{
+			CommandLine += ' ';
+		}
+		CommandLine += FWakaTimeCommandBuilder::QuoteArgument(Argument);
+	}
+	return CommandLine;
+}
+
+std::string FWakaTimeCommandBuilder::QuoteArgument(const std::string& Argument)
+{
+	if (!Argument.empty() && Argument.find_first_of(" \t\n\v\"") == std::string::npos)
+	{
+		return Argument;
+	}
+
+	// backslashes are only special in front of a quote, where each of them has to be doubled
+	std::string Quoted = "\"";
+	size_t NumBackslashes = 0;
+	for (char Character : Argument)
+	{
+		if (Character == '\\')
+		{
+			NumBackslashes++;
+			continue;
+		}
+
+		if (Character == '"')
+		{
+			Quoted.append(NumBackslashes * 2 + 1, '\\');
+		}
+		else
+		{
+			Quoted.append(NumBackslashes, '\\');
+		}
+		NumBackslashes = 0;
+		Quoted += Character;
+	}
+	Quoted.append(NumBackslashes * 2, '\\'); // the closing quote follows
+	Quoted += '"';
+	return Quoted;
+}
+
+static void AddCommonArguments(const FWakaTimeCliSettings& Settings, std::vector<std::string>& Arguments)
+{
+	Arguments.push_back("--config");
+	Arguments.push_back(Settings.ConfigPath);
+	Arguments.push_back("--log-file");
+	Arguments.push_back(Settings.LogPath);
+
+	if (!Settings.ApiUrl.empty())
+	{
+		Arguments.push_back("--api-url");
+		Arguments.push_back(Settings.ApiUrl);
+	}
+
+	Arguments.push_back("--plugin");
+	Arguments.push_back(Settings.Plugin);
+}
+
+FWakaTimeCommand FWakaTimeCommandBuilder::BuildHeartbeats(const FWakaTimeCliSettings& Settings,
+                                                          const std::vector<FWakaTimeHeartbeat>& Heartbeats)
+{
+	FWakaTimeCommand Command;
+	if (Heartbeats.empty())
+	{
+		return Command;
+	}
+
+	const FWakaTimeHeartbeat& Heartbeat = Heartbeats.front();
+	std::vector<std::string>& Arguments = Command.Arguments;
+	AddCommonArguments(Settings, Arguments);
+
+	char Time[32];
+	snprintf(Time, sizeof(Time), "%.3f", Heartbeat.Time);
+
+	Arguments.push_back("--project");
+	Arguments.push_back(Heartbeat.Project);
+	Arguments.push_back("--project-folder");
+	Arguments.push_back(Settings.ProjectFolder);
+	Arguments.push_back("--entity");
+	Arguments.push_back(Heartbeat.Entity);
+	Arguments.push_back("--entity-type");
+	Arguments.push_back(Heartbeat.EntityType);
+	Arguments.push_back("--language");
+	Arguments.push_back(Heartbeat.Language);
+	Arguments.push_back("--category");
+	Arguments.push_back(Heartbeat.Activity);
+	Arguments.push_back("--time");
+	Arguments.push_back(Time);
+
+	if (Heartbeat.bFileSave)
+	{
+		Arguments.push_back("--write");
+	}
+
+	// the rest goes through the standard input, one process sends them all
+	if (Heartbeats.size() > 1)
+	{
+		Arguments.push_back("--extra-heartbeats");
+		Command.StdinData = FWakaTimeJson::ToJsonArray(Heartbeats, 1);
+	}
+
+	return Command;
+}
+
+FWakaTimeCommand FWakaTimeCommandBuilder::BuildToday(const FWakaTimeCliSettings& Settings)
+{
+	FWakaTimeCommand Command;
+	AddCommonArguments(Settings, Command.Arguments);
+	Command.Arguments.push_back("--today");
+	return Command;
+}
+
+std::string FWakaTimeCommandBuilder::ParseTodayOutput(const std::string& Output)
+{
+	size_t First = Output.find_first_not_of(" \t\r\n");
+	if (First == std::string::npos)
+	{
+		return std::string();
+	}
+
+	size_t LineEnd = Output.find_first_of("\r\n", First);
+	std::string Line = Output.substr(First, LineEnd == std::string::npos ? std::string::npos : LineEnd - First);
+	return Line.substr(0, Line.find_last_not_of(" \t") + 1);
+}
@@ -0,0 +1,228 @@
+#include "WakaTimeConfig.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+static std::string TrimConfigText(const std::string& Text)
+{
+	size_t First = Text.find_first_not_of(" \t\r\n");
+	if (First == std::string::npos)
+	{
+		return std::string();
+	}
+	size_t Last = Text.find_last_not_of(" \t\r\n");
+	return Text.substr(First, Last - First + 1);
+}
+
+bool FWakaTimeConfig::Load(const std::string& Path)
+{
+	std::ifstream File(Path, std::ios::binary);
+	if (!File.is_open())
+	{
+		Lines.clear();
+		return false;
+	}
+
+	std::stringstream Text;
+	Text << File.rdbuf();
+	Parse(Text.str());
+	return true;
+}
+
+void FWakaTimeConfig::Parse(const std::string& Text)
+{
+	Lines.clear();
+
+	std::string Section;
+	std::istringstream Stream(Text);
+	std::string RawLine;
+	while (std::getline(Stream, RawLine))
+	{
+		if (!RawLine.empty() && RawLine.back() == '\r')
+		{
+			RawLine.pop_back();
+		}
+
+		FConfigLine Line;
+		Line.Text = RawLine;
+
+		std::string Trimmed = TrimConfigText(RawLine);
+		bool bIndented = !RawLine.empty() && (RawLine[0] == ' ' || RawLine[0] == '\t');
+
+		if (Trimmed.size() >= 2 && Trimmed.front() == '[' && Trimmed.back() == ']')
+		{
+			Section = TrimConfigText(Trimmed.substr(1, Trimmed.size() - 2));
+		}
+		else if (!Trimmed.empty() && Trimmed[0] != ';' && Trimmed[0] != '#' && !bIndented)
+		{
+			// indented lines continue the value above (e.g. the cli's exclude patterns) and are kept as they are
+			size_t Separator = Trimmed.find('=');
+			if (Separator != std::string::npos)
+			{
+				Line.Key = TrimConfigText(Trimmed.substr(0, Separator));
+				Line.Value = TrimConfigText(Trimmed.substr(Separator + 1));
+			}
+		}
+
+		Line.Section = Section;
+		Lines.push_back(Line);
+	}
+}
+
+bool FWakaTimeConfig::Save(const std::string& Path) const
+{
+	std::ofstream File(Path, std::ios::binary | std::ios::trunc);
+	if (!File.is_open())
+	{
+		return false;
+	}
+
+	File << Serialize();
+	return File.good();
+}
+
+std::string FWakaTimeConfig::Serialize() const
+{
+	std::string Text;
+	for (const FConfigLine& Line : Lines)
+	{
+		Text += Line.Text;
+		Text += '\n';
+	}
+	return Text;
+}
+
+int FWakaTimeConfig::FindEntry(const std::string& Section, const std::string& Key) const
+{
+	for (size_t Index = 0; Index < Lines.size(); Index++)
+	{
+		if (!Lines[Index].Key.empty() && Lines[Index].Section == Section && Lines[Index].Key == Key)
+		{
+			return static_cast<int>(Index);
+		}
+	}
+	return -1;
+}
+
+bool FWakaTimeConfig::Has(const std::string& Section, const std::string& Key) const
+{
+	return FindEntry(Section, Key) >= 0;
+}
+
+std::string FWakaTimeConfig::Get(const std::string& Section, const std::string& Key, const std::string& Default) const
+{
+	int Index = FindEntry(Section, Key);
+	return Index >= 0 ? Lines[Index].Value : Default;
+}
+
+double FWakaTimeConfig::GetDouble(const std::string& Section, const std::string& Key, double Default) const
+{
+	int Index = FindEntry(Section, Key);
+	if (Index < 0)
+	{
+		return Default;
+	}
+
+	const std::string& Value = Lines[Index].Value;
+	char* End = nullptr;
+	double Number = strtod(Value.c_str(), &End);
+	return End != Value.c_str() ? Number : Default;
+}
+
+bool FWakaTimeConfig::GetBool(const std::string& Section, const std::string& Key, bool Default) const
+{
+	int Index = FindEntry(Section, Key);
+	if (Index < 0)
+	{
+		return Default;
+	}
+
+	const std::string& Value = Lines[Index].Value;
+	if (Value == "true" || Value == "True" || Value == "1" || Value == "yes" || Value == "on")
+	{
+		return true;
+	}
+	if (Value == "false" || Value == "False" || Value == "0" || Value == "no" || Value == "off")
+	{
+		return false;
+	}
+	return Default;
+}
+
+bool FWakaTimeConfig::Set(const std::string& Section, const std::string& Key, const std::string& Value)
+{
+	FConfigLine Entry;
+	Entry.Text = Key + " = " + Value;
+	Entry.Section = Section;
+	Entry.Key = Key;
+	Entry.Value = Value;
+
+	int Index = FindEntry(Section, Key);
+	if (Index >= 0)
+	{
+		if (Lines[Index].Value == Value)
+		{
+			return false;
+		}
+		Lines[Index] = Entry;
+		return true;
+	}
+
+	// after the last key of the section, so trailing blank lines and comments stay in front of the next section
+	int InsertAt = -1;
+	for (size_t LineIndex = 0; LineIndex < Lines.size(); LineIndex++)
+	{
+		if (Lines[LineIndex].Section != Section)
+		{
+			continue;
+		}
+
+		std::string Trimmed = TrimConfigText(Lines[LineIndex].Text);
+		bool bIsHeader = !Trimmed.empty() && Trimmed.front() == '[';
+		bool bIsContinuation = !Lines[LineIndex].Text.empty() && (Lines[LineIndex].Text[0] == ' ' || Lines[LineIndex].Text[0] == '\t');
+		if (bIsHeader || !Lines[LineIndex].Key.empty() || (bIsContinuation && !Trimmed.empty()))
+		{
+			InsertAt = static_cast<int>(LineIndex) + 1;
+		}
+	}
+
+	if (InsertAt < 0)
+	{
+		if (!Lines.empty() && !TrimConfigText(Lines.back().Text).empty())
+		{
+			FConfigLine Blank;
+			Blank.Section = Lines.back().Section;
+			Lines.push_back(Blank);
+		}
+
+		FConfigLine Header;
+		Header.Text = "[" + Section + "]";
+		Header.Section = Section;
+		Lines.push_back(Header);
+		InsertAt = static_cast<int>(Lines.size());
+	}
+
+	Lines.insert(Lines.begin() + InsertAt, Entry);
+	return true;
+}
+
+bool FWakaTimeConfig::Remove(const std::string& Section, const std::string& Key)
+{
+	int Index = FindEntry(Section, Key);
+	if (Index < 0)
+	{
+		return false;
+	}
+
+	// continuation lines belong to the value
+	size_t End = static_cast<size_t>(Index) + 1;
+	while (End < Lines.size() && Lines[End].Key.empty() && !Lines[End].Text.empty() &&
+		(Lines[End].Text[0] == ' ' || Lines[End].Text[0] == '\t'))
+	{
+		End++;
+	}
+
+	Lines.erase(Lines.begin() + Index, Lines.begin() + End);
+	return true;
+}
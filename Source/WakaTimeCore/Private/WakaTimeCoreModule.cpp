@@ -0,0 +1,4 @@
+// Only compiled by UnrealBuildTool; the rest of the module is plain C++ and also builds with the CMakeLists.txt next to it
+#include "Modules/ModuleManager.h"
+
+IMPLEMENT_MODULE(FDefaultModuleImpl, WakaTimeCore)
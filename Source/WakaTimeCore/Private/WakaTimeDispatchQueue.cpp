@@ -0,0 +1,157 @@
+#include "WakaTimeDispatchQueue.h"
+
+#include <algorithm>
+
+void FWakaTimeDispatchQueue::FLane::PushBack(FPendingHeartbeat&& Pending)
+{
+	Slots[(Head + Count) % Slots.size()] = std::move(Pending);
+	Count++;
+}
+
+void FWakaTimeDispatchQueue::FLane::PopFront()
+{
+	// the slot keeps its strings, so their buffers are reused by the next heartbeat written into it
+	Head = (Head + 1) % Slots.size();
+	Count--;
+}
+
+FWakaTimeDispatchQueue::FWakaTimeDispatchQueue(double InMaxDelaySeconds, size_t InWriteCapacity, size_t InInfoCapacity)
+	: MaxDelaySeconds(InMaxDelaySeconds)
+{
+	WriteLane.Slots.resize(std::max<size_t>(1, InWriteCapacity));
+	InfoLane.Slots.resize(std::max<size_t>(1, InInfoCapacity));
+}
+
+bool FWakaTimeDispatchQueue::Merge(FLane& Lane, const FWakaTimeHeartbeat& Heartbeat)
+{
+	// the cli only needs to know the entity is still being worked on, so an identical waiting heartbeat just moves forward in time
+	for (size_t Index = 0; Index < Lane.Count; Index++)
+	{
+		FWakaTimeHeartbeat& Waiting = Lane.At(Index).Heartbeat;
+		if (Waiting.IsSameActivity(Heartbeat))
+		{
+			if (Heartbeat.Time > Waiting.Time)
+			{
+				Waiting.Time = Heartbeat.Time;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+EWakaTimeEnqueueResult FWakaTimeDispatchQueue::Enqueue(const FWakaTimeHeartbeat& Heartbeat, double Now)
+{
+	Stats.NumEnqueued++;
+
+	FLane& Lane = Heartbeat.bFileSave ? WriteLane : InfoLane;
+	if (Merge(Lane, Heartbeat))
+	{
+		Stats.NumMerged++;
+		return EWakaTimeEnqueueResult::Merged;
+	}
+
+	EWakaTimeEnqueueResult Result = EWakaTimeEnqueueResult::Queued;
+	if (Lane.IsFull())
+	{
+		if (&Lane == &WriteLane)
+		{
+			Stats.NumWriteOverflows++;
+			return EWakaTimeEnqueueResult::WriteLaneFull;
+		}
+
+		InfoLane.PopFront();
+		Stats.NumShed++;
+		Result = EWakaTimeEnqueueResult::ShedOldest;
+	}
+
+	FPendingHeartbeat NewPending;
+	NewPending.Heartbeat = Heartbeat;
+	NewPending.EnqueueTime = Now;
+	Lane.PushBack(std::move(NewPending));
+
+	Stats.PeakWrite = std::max(Stats.PeakWrite, static_cast<uint32_t>(WriteLane.Count));
+	Stats.PeakInfo = std::max(Stats.PeakInfo, static_cast<uint32_t>(InfoLane.Count));
+	return Result;
+}
+
+bool FWakaTimeDispatchQueue::IsOldestOverdue(double Now) const
+{
+	return WriteLane.Count > 0 || (InfoLane.Count > 0 && Now - InfoLane.At(0).EnqueueTime >= MaxDelaySeconds);
+}
+
+bool FWakaTimeDispatchQueue::PopReady(double Now, bool bBusy, FWakaTimeHeartbeat& OutHeartbeat)
+{
+	// saves are rare and carry the most information, they are not held back
+	if (WriteLane.Count > 0)
+	{
+		Release(WriteLane, Now, false, OutHeartbeat);
+		return true;
+	}
+
+	if (InfoLane.Count == 0)
+	{
+		return false;
+	}
+
+	FPendingHeartbeat& Oldest = InfoLane.At(0);
+	bool bOverdue = Now - Oldest.EnqueueTime >= MaxDelaySeconds;
+
+	if (!bOverdue && bBusy)
+	{
+		Oldest.bWasDeferred = true;
+		return false;
+	}
+
+	Release(InfoLane, Now, bOverdue, OutHeartbeat);
+	return true;
+}
+
+void FWakaTimeDispatchQueue::Release(FLane& Lane, double Now, bool bOverdue, FWakaTimeHeartbeat& OutHeartbeat)
+{
+	FPendingHeartbeat& Oldest = Lane.At(0);
+	double Waited = Now - Oldest.EnqueueTime;
+
+	if (Oldest.bWasDeferred)
+	{
+		Stats.NumDeferred++;
+		Oldest.bWasDeferred = false;
+	}
+	if (bOverdue)
+	{
+		Stats.NumForcedByMaxDelay++;
+	}
+	if (Waited > Stats.LongestDelaySeconds)
+	{
+		Stats.LongestDelaySeconds = Waited;
+	}
+
+	OutHeartbeat = Oldest.Heartbeat;
+	Lane.PopFront();
+}
+
+std::vector<FWakaTimeHeartbeat> FWakaTimeDispatchQueue::TakeAll()
+{
+	std::vector<FWakaTimeHeartbeat> Taken;
+	Taken.reserve(Num());
+
+	size_t WriteIndex = 0;
+	size_t InfoIndex = 0;
+	while (WriteIndex < WriteLane.Count || InfoIndex < InfoLane.Count)
+	{
+		bool bTakeWrite = InfoIndex >= InfoLane.Count ||
+			(WriteIndex < WriteLane.Count && WriteLane.At(WriteIndex).EnqueueTime <= InfoLane.At(InfoIndex).EnqueueTime);
+		FLane& Lane = bTakeWrite ? WriteLane : InfoLane;
+		size_t& Index = bTakeWrite ? WriteIndex : InfoIndex;
+		Taken.push_back(Lane.At(Index++).Heartbeat);
+	}
+
+	WriteLane.Head = WriteLane.Count = 0;
+	InfoLane.Head = InfoLane.Count = 0;
+	return Taken;
+}
+
+size_t FWakaTimeDispatchQueue::GetSlotBytes() const
+{
+	return (WriteLane.Slots.size() + InfoLane.Slots.size()) * sizeof(FPendingHeartbeat);
+}
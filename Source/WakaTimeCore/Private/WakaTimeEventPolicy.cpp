@@ -0,0 +1,37 @@
+#include "WakaTimeEventPolicy.h"
+
+#include <cmath>
+
+#include "WakaTimeConfig.h"
+
+FWakaTimeEventPolicy FWakaTimeEventPolicy::Load(const FWakaTimeConfig& Config, const std::string& Section,
+                                                const std::string& EventName, const FWakaTimeEventPolicy& Default)
+{
+	FWakaTimeEventPolicy Policy = Default;
+	std::string Prefix = EventName + ".";
+
+	Policy.bEnabled = Config.GetBool(Section, Prefix + "enabled", Default.bEnabled);
+
+	double SampleRate = Config.GetDouble(Section, Prefix + "sample_rate", Default.SampleRate);
+	if (std::isnan(SampleRate))
+	{
+		SampleRate = Default.SampleRate;
+	}
+	Policy.SampleRate = static_cast<float>(SampleRate < 0.0 ? 0.0 : SampleRate > 1.0 ? 1.0 : SampleRate);
+
+	double MinInterval = Config.GetDouble(Section, Prefix + "min_interval", Default.MinIntervalSeconds);
+	Policy.MinIntervalSeconds = MinInterval > 0.0 && std::isfinite(MinInterval) ? MinInterval : Default.MinIntervalSeconds;
+
+	std::string Priority = Config.Get(Section, Prefix + "priority");
+	if (Priority == "high")
+	{
+		Policy.bHighPriority = true;
+	}
+	else if (Priority == "normal")
+	{
+		Policy.bHighPriority = false;
+	}
+
+	Policy.Category = Config.Get(Section, Prefix + "category", Default.Category);
+	return Policy;
+}
@@ -0,0 +1,237 @@
+#include "WakaTimeJson.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+void FWakaTimeJson::AppendString(std::string& Json, const std::string& Value)
+{
+	Json += '"';
+	for (char Character : Value)
+	{
+		switch (Character)
+		{
+		case '"': Json += "\\\""; break;
+		case '\\': Json += "\\\\"; break;
+		case '\n': Json += "\\n"; break;
+		case '\r': Json += "\\r"; break;
+		case '\t': Json += "\\t"; break;
+		default:
+			if (static_cast<unsigned char>(Character) < 0x20)
+			{
+				char Escaped[8];
+				snprintf(Escaped, sizeof(Escaped), "\\u%04x", static_cast<unsigned int>(Character));
+				Json += Escaped;
+			}
+			else
+			{
+				Json += Character; // UTF-8 passes through
+			}
+		}
+	}
+	Json += '"';
+}
+
+std::string FWakaTimeJson::ToJson(const FWakaTimeHeartbeat& Heartbeat)
+{
+	char Time[32];
+	snprintf(Time, sizeof(Time), "%.3f", Heartbeat.Time);
+
+	std::string Json = "{\"entity\":";
+	AppendString(Json, Heartbeat.Entity);
+	Json += ",\"type\":";
+	AppendString(Json, Heartbeat.EntityType);
+	Json += ",\"category\":";
+	AppendString(Json, Heartbeat.Activity);
+	Json += ",\"language\":";
+	AppendString(Json, Heartbeat.Language);
+	Json += ",\"project\":";
+	AppendString(Json, Heartbeat.Project);
+	Json += ",\"time\":";
+	Json += Time;
+	Json += ",\"is_write\":";
+	Json += Heartbeat.bFileSave ? "true" : "false";
+	Json += '}';
+	return Json;
+}
+
+std::string FWakaTimeJson::ToJsonArray(const std::vector<FWakaTimeHeartbeat>& Heartbeats, size_t First)
+{
+	std::string Json = "[";
+	for (size_t Index = First; Index < Heartbeats.size(); Index++)
+	{
+		if (Index > First)
+		{
+			Json += ',';
+		}
+		Json += ToJson(Heartbeats[Index]);
+	}
+	Json += ']';
+	return Json;
+}
+
+static void SkipJsonWhitespace(const std::string& Json, size_t& Offset)
+{
+	while (Offset < Json.size() && (Json[Offset] == ' ' || Json[Offset] == '\t' || Json[Offset] == '\r' || Json[Offset] == '\n'))
+	{
+		Offset++;
+	}
+}
+
+static void AppendUtf8(std::string& Out, unsigned int CodePoint)
+{
+	if (CodePoint < 0x80)
+	{
+		Out += static_cast<char>(CodePoint);
+	}
+	else if (CodePoint < 0x800)
+	{
+		Out += static_cast<char>(0xC0 | (CodePoint >> 6));
+		Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+	}
+	else
+	{
+		Out += static_cast<char>(0xE0 | (CodePoint >> 12));
+		Out += static_cast<char>(0x80 | ((CodePoint >> 6) & 0x3F));
+		Out += static_cast<char>(0x80 | (CodePoint & 0x3F));
+	}
+}
+
+static bool ParseJsonString(const std::string& Json, size_t& Offset, std::string& OutValue)
+{
+	if (Offset >= Json.size() || Json[Offset] != '"')
+	{
+		return false;
+	}
+	Offset++;
+
+	OutValue.clear();
+	while (Offset < Json.size())
+	{
+		char Character = Json[Offset++];
+		if (Character == '"')
+		{
+			return true;
+		}
+		if (Character != '\\')
+		{
+			OutValue += Character;
+			continue;
+		}
+
+		if (Offset >= Json.size())
+		{
+			return false;
+		}
+		char Escape = Json[Offset++];
+		switch (Escape)
+		{
+		case 'n': OutValue += '\n'; break;
+		case 'r': OutValue += '\r'; break;
+		case 't': OutValue += '\t'; break;
+		case 'b': OutValue += '\b'; break;
+		case 'f': OutValue += '\f'; break;
+		case 'u':
+			{
+				if (Offset + 4 > Json.size())
+				{
+					return false;
+				}
+				// surrogate pairs are not combined; ToJson only escapes control characters
+				AppendUtf8(OutValue, static_cast<unsigned int>(strtoul(Json.substr(Offset, 4).c_str(), nullptr, 16)));
+				Offset += 4;
+				break;
+			}
+		default: OutValue += Escape; break; // \" \\ \/
+		}
+	}
+	return false;
+}
+
+bool FWakaTimeJson::FromJson(const std::string& Json, FWakaTimeHeartbeat& OutHeartbeat)
+{
+	size_t Offset = 0;
+	SkipJsonWhitespace(Json, Offset);
+	if (Offset >= Json.size() || Json[Offset] != '{')
+	{
+		return false;
+	}
+	Offset++;
+
+	FWakaTimeHeartbeat Heartbeat;
+	std::string Key;
+	std::string Value;
+
+	SkipJsonWhitespace(Json, Offset);
+	if (Offset < Json.size() && Json[Offset] == '}')
+	{
+		OutHeartbeat = Heartbeat;
+		return true;
+	}
+
+	while (Offset < Json.size())
+	{
+		SkipJsonWhitespace(Json, Offset);
+		if (!ParseJsonString(Json, Offset, Key))
+		{
+			return false;
+		}
+
+		SkipJsonWhitespace(Json, Offset);
+		if (Offset >= Json.size() || Json[Offset] != ':')
+		{
+			return false;
+		}
+		Offset++;
+		SkipJsonWhitespace(Json, Offset);
+		if (Offset >= Json.size())
+		{
+			return false;
+		}
+
+		if (Json[Offset] == '"')
+		{
+			if (!ParseJsonString(Json, Offset, Value))
+			{
+				return false;
+			}
+
+			if (Key == "entity") Heartbeat.Entity = Value;
+			else if (Key == "type") Heartbeat.EntityType = Value;
+			else if (Key == "category") Heartbeat.Activity = Value;
+			else if (Key == "language") Heartbeat.Language = Value;
+			else if (Key == "project") Heartbeat.Project = Value;
+		}
+		else
+		{
+			// numbers, true, false and null run up to the next separator
+			size_t ValueEnd = Json.find_first_of(",} \t\r\n", Offset);
+			if (ValueEnd == std::string::npos)
+			{
+				return false;
+			}
+			Value = Json.substr(Offset, ValueEnd - Offset);
+			Offset = ValueEnd;
+
+			if (Key == "time") Heartbeat.Time = strtod(Value.c_str(), nullptr);
+			else if (Key == "is_write") Heartbeat.bFileSave = Value == "true";
+		}
+
+		SkipJsonWhitespace(Json, Offset);
+		if (Offset >= Json.size())
+		{
+			return false;
+		}
+		if (Json[Offset] == '}')
+		{
+			OutHeartbeat = Heartbeat;
+			return true;
+		}
+		if (Json[Offset] != ',')
+		{
+			return false;
+		}
+		Offset++;
+	}
+
+	return false;
+}
@@ -0,0 +1,35 @@
+#include "WakaTimeSessionPacer.h"
+
+void FWakaTimeSessionPacer::Start(double Now)
+{
+	LastTime = Now;
+	bActive = true;
+}
+
+std::vector<double> FWakaTimeSessionPacer::Advance(double Now)
+{
+	std::vector<double> Times;
+	if (!bActive || IntervalSeconds <= 0.0)
+	{
+		return Times;
+	}
+
+	while (LastTime + IntervalSeconds <= Now)
+	{
+		LastTime += IntervalSeconds;
+		Times.push_back(LastTime);
+	}
+	return Times;
+}
+
+std::vector<double> FWakaTimeSessionPacer::Stop(double Now)
+{
+	std::vector<double> Times = Advance(Now);
+	if (bActive && Now > LastTime)
+	{
+		Times.push_back(Now);
+	}
+
+	bActive = false;
+	return Times;
+}
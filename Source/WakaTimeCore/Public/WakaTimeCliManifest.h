@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+
+#include "WakaTimeCoreDefines.h"
+
+/// <summary>
+///	What is known about an installed wakatime-cli binary. Kept in a small ini file beside the cli, one section per binary,
+///	so every engine version and project on the machine shares it (and only one of them checks for updates per interval).
+/// </summary>
+struct WAKATIMECORE_API FWakaTimeCliManifest
+{
+	/// <summary> Release tag of the installed binary, e.g. v1.98.0; empty if not known </summary>
+	std::string Version;
+
+	/// <summary> Hash of the binary when the version was determined; another IDE replacing the binary changes it </summary>
+	std::string Checksum;
+
+	/// <summary> Unix time of the last update check in seconds </summary>
+	double LastCheckTime = 0.0;
+
+	/// <summary>
+	///	Reads the section of the binary from the manifest file
+	/// </summary>
+	/// <param name="ExeName"> File name of the binary, e.g. wakatime-cli-windows-amd64.exe </param>
+	/// <returns> False if the file could not be opened; the manifest is empty then </returns>
+	bool Load(const std::string& Path, const std::string& ExeName);
+
+	/// <summary>
+	///	Writes the section of the binary into the manifest file; the sections of other binaries are kept
+	/// </summary>
+	bool Save(const std::string& Path, const std::string& ExeName) const;
+
+	/// <summary>
+	///	Whether the last update check is older than the interval
+	/// </summary>
+	bool IsCheckDue(double Now, double IntervalSeconds) const;
+
+	/// <summary>
+	///	Compares two release tags numerically, e.g. v1.100.0 is newer than v1.99.2; a leading "v" is optional
+	/// </summary>
+	/// <returns> True if the candidate is newer, or the installed version is not known </returns>
+	static bool IsNewerVersion(const std::string& Candidate, const std::string& Installed);
+
+	/// <summary>
+	///	Returns the tag_name of a GitHub release, or an empty string if there is none
+	/// </summary>
+	static std::string ParseReleaseTag(const std::string& ReleaseJson);
+
+	/// <summary>
+	///	Returns the version printed by "wakatime-cli --version", or an empty string if the output is not a version
+	/// </summary>
+	static std::string ParseVersionOutput(const std::string& Output);
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "WakaTimeCoreDefines.h"
+#include "WakaTimeHeartbeat.h"
+
+/// <summary>
+///	Everything about the cli invocation that is the same for every heartbeat
+/// </summary>
+struct FWakaTimeCliSettings
+{
+	/// <summary> Path to the wakatime.cfg file </summary>
+	std::string ConfigPath;
+
+	/// <summary> Path to the log file of the cli </summary>
+	std::string LogPath;
+
+	/// <summary> Custom api url; empty uses the one from the config file </summary>
+	std::string ApiUrl;
+
+	/// <summary> Root folder of the project, used by the cli to make entities relative </summary>
+	std::string ProjectFolder;
+
+	/// <summary> Plugin identifier, e.g. unreal-wakatime/1.2.6 </summary>
+	std::string Plugin;
+};
+
+/// <summary>
+///	Arguments and standard input of a single cli call
+/// </summary>
+struct FWakaTimeCommand
+{
+	/// <summary> Arguments, without the exe itself </summary>
+	std::vector<std::string> Arguments;
+
+	/// <summary> Written to the standard input of the cli; empty if nothing has to be written </summary>
+	std::string StdinData;
+
+	/// <summary>
+	///	Returns the arguments joined into a Windows command line, quoted so CommandLineToArgvW splits them back unchanged
+	/// </summary>
+	WAKATIMECORE_API std::string ToCommandLine() const;
+};
+
+/// <summary>
+///	Builds wakatime-cli calls
+/// </summary>
+class WAKATIMECORE_API FWakaTimeCommandBuilder
+{
+public:
+	/// <summary>
+	///	Builds a single call for the heartbeats; the first one goes on the command line, the rest as --extra-heartbeats
+	/// </summary>
+	/// <param name="Heartbeats"> At least one heartbeat </param>
+	static FWakaTimeCommand BuildHeartbeats(const FWakaTimeCliSettings& Settings,
+	                                        const std::vector<FWakaTimeHeartbeat>& Heartbeats);
+
+	/// <summary>
+	///	Builds a call that prints the time tracked today, e.g. "3 hrs 12 mins Coding, 40 mins Designing"
+	/// </summary>
+	static FWakaTimeCommand BuildToday(const FWakaTimeCliSettings& Settings);
+
+	/// <summary>
+	///	Returns the summary printed by a --today call, without surrounding whitespace and anything after the first line
+	/// </summary>
+	static std::string ParseTodayOutput(const std::string& Output);
+
+	/// <summary>
+	///	Quotes a single argument for a Windows command line if it needs to be
+	/// </summary>
+	static std::string QuoteArgument(const std::string& Argument);
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "WakaTimeCoreDefines.h"
+
+/// <summary>
+///	Section aware reader and writer of the wakatime.cfg ini file. The file is shared with the cli and other IDE plugins,
+///	so everything this class does not touch (other sections, comments, multi-line values, order) is written back unchanged.
+/// </summary>
+class WAKATIMECORE_API FWakaTimeConfig
+{
+public:
+	/// <summary>
+	///	Reads the file
+	/// </summary>
+	/// <returns> False if the file could not be opened; the config is empty then </returns>
+	bool Load(const std::string& Path);
+
+	/// <summary>
+	///	Replaces the config with the parsed text
+	/// </summary>
+	void Parse(const std::string& Text);
+
+	/// <summary>
+	///	Writes the config into the file
+	/// </summary>
+	/// <returns> False if the file could not be written </returns>
+	bool Save(const std::string& Path) const;
+
+	/// <summary>
+	///	Returns the config as the text of an ini file
+	/// </summary>
+	std::string Serialize() const;
+
+	bool Has(const std::string& Section, const std::string& Key) const;
+
+	/// <summary>
+	///	Returns the value of the key, or the default if the key is not in the section
+	/// </summary>
+	std::string Get(const std::string& Section, const std::string& Key, const std::string& Default = "") const;
+
+	/// <summary>
+	///	Returns the value as a number; the default if missing or not a number
+	/// </summary>
+	double GetDouble(const std::string& Section, const std::string& Key, double Default) const;
+
+	/// <summary>
+	///	Returns the value as a bool (true, 1, yes and on are true; false, 0, no and off are false); the default if missing
+	///	or anything else
+	/// </summary>
+	bool GetBool(const std::string& Section, const std::string& Key, bool Default) const;
+
+	/// <summary>
+	///	Sets the value, adding the key (and the section) if needed
+	/// </summary>
+	/// <returns> Whether the config changed </returns>
+	bool Set(const std::string& Section, const std::string& Key, const std::string& Value);
+
+	/// <summary>
+	///	Removes the key from the section
+	/// </summary>
+	/// <returns> Whether the key was there </returns>
+	bool Remove(const std::string& Section, const std::string& Key);
+
+private:
+	struct FConfigLine
+	{
+		/// <summary> The line as it was read; rebuilt from key and value once the value is set </summary>
+		std::string Text;
+
+		/// <summary> Section the line belongs to </summary>
+		std::string Section;
+
+		/// <summary> Empty for section headers, comments, blank lines and continuation lines </summary>
+		std::string Key;
+
+		std::string Value;
+	};
+
+	int FindEntry(const std::string& Section, const std::string& Key) const;
+
+	std::vector<FConfigLine> Lines;
+};
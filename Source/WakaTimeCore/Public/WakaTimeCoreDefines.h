@@ -0,0 +1,6 @@
+#pragma once
+
+// Defined by UnrealBuildTool when the core is built as an editor module; empty in the plain CMake build
+#ifndef WAKATIMECORE_API
+#define WAKATIMECORE_API
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "WakaTimeCoreDefines.h"
+#include "WakaTimeHeartbeat.h"
+
+/// <summary>
+///	What happened to a heartbeat given to FWakaTimeDispatchQueue::Enqueue
+/// </summary>
+enum class EWakaTimeEnqueueResult : uint8_t
+{
+	/// <summary> Waits in its lane </summary>
+	Queued,
+	/// <summary> An identical waiting heartbeat was moved forward in time instead </summary>
+	Merged,
+	/// <summary> Queued, the oldest informational heartbeat was dropped to make room </summary>
+	ShedOldest,
+	/// <summary> The write lane is full; the heartbeat was not queued and has to be kept elsewhere </summary>
+	WriteLaneFull
+};
+
+/// <summary>
+///	Heartbeats waiting to be sent, in two lanes of fixed capacity. Saves go into the write lane, which is never shed
+///	and released before anything else; the rest go into the informational lane, where identical heartbeats are merged
+///	and the oldest one is dropped once it is full. Informational heartbeats are released when the caller is not busy
+///	or once they waited longer than the maximum delay. Times are seconds of any monotonic clock the caller uses.
+/// </summary>
+class WAKATIMECORE_API FWakaTimeDispatchQueue
+{
+public:
+	struct FStats
+	{
+		uint32_t NumEnqueued = 0;
+		uint32_t NumMerged = 0;
+		uint32_t NumDeferred = 0;
+		uint32_t NumForcedByMaxDelay = 0;
+		uint32_t NumShed = 0;
+		uint32_t NumWriteOverflows = 0;
+		uint32_t PeakWrite = 0;
+		uint32_t PeakInfo = 0;
+		double LongestDelaySeconds = 0.0;
+	};
+
+	/// <param name="InMaxDelaySeconds"> Longest time an informational heartbeat can be held back </param>
+	/// <param name="InWriteCapacity"> Slots of the write lane </param>
+	/// <param name="InInfoCapacity"> Slots of the informational lane </param>
+	explicit FWakaTimeDispatchQueue(double InMaxDelaySeconds = 30.0, size_t InWriteCapacity = 64,
+	                                size_t InInfoCapacity = 256);
+
+	void SetMaxDelay(double InMaxDelaySeconds) { MaxDelaySeconds = InMaxDelaySeconds; }
+
+	/// <summary>
+	///	Queues the heartbeat in its lane, or moves an identical waiting heartbeat forward in time
+	/// </summary>
+	EWakaTimeEnqueueResult Enqueue(const FWakaTimeHeartbeat& Heartbeat, double Now);
+
+	/// <summary>
+	///	Whether a write heartbeat waits, or the oldest informational heartbeat waited longer than the maximum delay
+	/// </summary>
+	bool IsOldestOverdue(double Now) const;
+
+	/// <summary>
+	///	Removes the oldest write heartbeat, or else the oldest informational heartbeat if it may be sent now:
+	///	the caller is not busy or it is overdue
+	/// </summary>
+	/// <returns> False if nothing may be sent </returns>
+	bool PopReady(double Now, bool bBusy, FWakaTimeHeartbeat& OutHeartbeat);
+
+	/// <summary>
+	///	Removes every waiting heartbeat of both lanes, oldest first
+	/// </summary>
+	std::vector<FWakaTimeHeartbeat> TakeAll();
+
+	bool IsEmpty() const { return WriteLane.Count == 0 && InfoLane.Count == 0; }
+	size_t Num() const { return WriteLane.Count + InfoLane.Count; }
+
+	/// <summary>
+	///	Bytes taken by the slots of both lanes; allocated once, independent of the event rate
+	/// </summary>
+	size_t GetSlotBytes() const;
+
+	const FStats& GetStats() const { return Stats; }
+
+private:
+	struct FPendingHeartbeat
+	{
+		FWakaTimeHeartbeat Heartbeat;
+		double EnqueueTime = 0.0;
+		bool bWasDeferred = false;
+	};
+
+	/// <summary>
+	///	Ring buffer over slots allocated up front
+	/// </summary>
+	struct FLane
+	{
+		std::vector<FPendingHeartbeat> Slots;
+		size_t Head = 0;
+		size_t Count = 0;
+
+		bool IsFull() const { return Count == Slots.size(); }
+		FPendingHeartbeat& At(size_t Index) { return Slots[(Head + Index) % Slots.size()]; }
+		const FPendingHeartbeat& At(size_t Index) const { return Slots[(Head + Index) % Slots.size()]; }
+		void PushBack(FPendingHeartbeat&& Pending);
+		void PopFront();
+	};
+
+	static bool Merge(FLane& Lane, const FWakaTimeHeartbeat& Heartbeat);
+	void Release(FLane& Lane, double Now, bool bOverdue, FWakaTimeHeartbeat& OutHeartbeat);
+
+	double MaxDelaySeconds = 30.0;
+	FLane WriteLane;
+	FLane InfoLane;
+	FStats Stats;
+};
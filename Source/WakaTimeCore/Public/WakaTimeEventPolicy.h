@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+#include "WakaTimeCoreDefines.h"
+
+class FWakaTimeConfig;
+
+/// <summary>
+///	How heartbeats of one kind of event are produced
+/// </summary>
+struct WAKATIMECORE_API FWakaTimeEventPolicy
+{
+	/// <summary> Disabled events are still recorded into traces, but produce no heartbeats </summary>
+	bool bEnabled = true;
+
+	/// <summary> Share of the events that produce a heartbeat, 0 to 1 </summary>
+	float SampleRate = 1.0f;
+
+	/// <summary> Events closer than this to the last heartbeat of the same kind produce none </summary>
+	double MinIntervalSeconds = 0.0;
+
+	/// <summary> High priority heartbeats skip the scheduler and are sent right away </summary>
+	bool bHighPriority = false;
+
+	/// <summary> Category the heartbeats are reported under; e.g. coding, designing, debugging </summary>
+	std::string Category;
+
+	/// <summary>
+	///	Reads the overrides of an event from the section, e.g. "PieStarted.enabled = false"; keys that are missing keep
+	///	the default. Supported keys: enabled, sample_rate, min_interval, priority (normal, high) and category
+	/// </summary>
+	static FWakaTimeEventPolicy Load(const FWakaTimeConfig& Config, const std::string& Section, const std::string& EventName,
+	                                 const FWakaTimeEventPolicy& Default);
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+/// <summary>
+///	Everything needed to build a single wakatime-cli heartbeat
+/// </summary>
+struct FWakaTimeHeartbeat
+{
+	/// <summary> Activity being performed by the user; e.g. coding, designing, debugging, etc. </summary>
+	std::string Activity;
+
+	/// <summary> file, app or domain </summary>
+	std::string EntityType;
+
+	/// <summary> Path to the file or name of the app that is being worked on </summary>
+	std::string Entity;
+
+	std::string Language;
+
+	/// <summary> Name of the project the heartbeat belongs to </summary>
+	std::string Project;
+
+	/// <summary> Whether the entity was saved </summary>
+	bool bFileSave = false;
+
+	/// <summary> Unix time of the activity in seconds; heartbeats can be sent later than they happened </summary>
+	double Time = 0.0;
+
+	/// <summary>
+	///	Whether both heartbeats describe the same activity, so only the later one has to be sent
+	/// </summary>
+	bool IsSameActivity(const FWakaTimeHeartbeat& Other) const
+	{
+		return bFileSave == Other.bFileSave && Entity == Other.Entity && Activity == Other.Activity &&
+			EntityType == Other.EntityType && Language == Other.Language && Project == Other.Project;
+	}
+};
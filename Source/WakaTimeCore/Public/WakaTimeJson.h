@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "WakaTimeCoreDefines.h"
+#include "WakaTimeHeartbeat.h"
+
+/// <summary>
+///	Converts heartbeats from and into the JSON wakatime-cli reads with --extra-heartbeats
+/// </summary>
+class WAKATIMECORE_API FWakaTimeJson
+{
+public:
+	/// <summary>
+	///	Returns the heartbeat as a single line JSON object
+	/// </summary>
+	static std::string ToJson(const FWakaTimeHeartbeat& Heartbeat);
+
+	/// <summary>
+	///	Returns the heartbeats from First on as a JSON array
+	/// </summary>
+	static std::string ToJsonArray(const std::vector<FWakaTimeHeartbeat>& Heartbeats, size_t First = 0);
+
+	/// <summary>
+	///	Parses a single JSON object as written by ToJson. Unknown keys are skipped, nested values are not supported
+	/// </summary>
+	/// <returns> False if the text is not a complete JSON object </returns>
+	static bool FromJson(const std::string& Json, FWakaTimeHeartbeat& OutHeartbeat);
+
+	/// <summary>
+	///	Appends the value as a quoted and escaped JSON string
+	/// </summary>
+	static void AppendString(std::string& Json, const std::string& Value);
+};
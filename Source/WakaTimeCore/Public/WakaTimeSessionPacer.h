@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "WakaTimeCoreDefines.h"
+
+/// <summary>
+///	Turns a long continuous activity without events of its own (e.g. a play session) into heartbeat times,
+///	one per interval, so the dashboard shows the whole span instead of its start and end.
+/// </summary>
+class WAKATIMECORE_API FWakaTimeSessionPacer
+{
+public:
+	/// <param name="InIntervalSeconds"> Time between two heartbeats; should stay well below the cli's idle timeout </param>
+	explicit FWakaTimeSessionPacer(double InIntervalSeconds = 120.0) : IntervalSeconds(InIntervalSeconds) { }
+
+	/// <summary>
+	///	Starts a session; the start itself is expected to be reported by the caller
+	/// </summary>
+	void Start(double Now);
+
+	bool IsActive() const { return bActive; }
+
+	/// <summary>
+	///	Returns the heartbeat times since the last call, one per full interval
+	/// </summary>
+	std::vector<double> Advance(double Now);
+
+	/// <summary>
+	///	Returns what Advance would, plus the end of the session, and ends it
+	/// </summary>
+	std::vector<double> Stop(double Now);
+
+private:
+	double IntervalSeconds = 120.0;
+	double LastTime = 0.0;
+	bool bActive = false;
+};
@@ -0,0 +1,17 @@
+using UnrealBuildTool;
+
+public class WakaTimeCore : ModuleRules
+{
+	public WakaTimeCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		// the sources only use the standard library (see CMakeLists.txt); Core is needed for the module boilerplate alone
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core"
+			}
+			);
+	}
+}
@@ -0,0 +1,118 @@
+// Micro benchmarks of the engine independent core: the work done per editor event (enqueueing and merging) and per
+// cli call (building the command and the --extra-heartbeats JSON). Built by Source/WakaTimeCore/CMakeLists.txt.
+// Prints nanoseconds per operation; pass a number to scale the iteration counts, e.g. 10 for steadier numbers.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "WakaTimeCommand.h"
+#include "WakaTimeConfig.h"
+#include "WakaTimeDispatchQueue.h"
+#include "WakaTimeJson.h"
+
+// Keeps the optimizer from removing the measured work
+static size_t GSink = 0;
+
+template <typename FunctionType>
+static void Measure(const char* Name, int Iterations, FunctionType&& Function)
+{
+	auto Start = std::chrono::steady_clock::now();
+	for (int Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		Function(Iteration);
+	}
+	double Nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+	std::printf("%-40s %10.1f ns/op (%d iterations)\n", Name, Nanoseconds / Iterations, Iterations);
+}
+
+static FWakaTimeHeartbeat MakeHeartbeat(int Index, bool bFileSave = false)
+{
+	FWakaTimeHeartbeat Heartbeat;
+	Heartbeat.Activity = "designing";
+	Heartbeat.EntityType = "file";
+	Heartbeat.Entity = "C:\\Projects\\My Game\\Content\\Maps\\Map_" + std::to_string(Index) + ".umap";
+	Heartbeat.Language = "Unreal Editor";
+	Heartbeat.Project = "My Game";
+	Heartbeat.bFileSave = bFileSave;
+	Heartbeat.Time = 1760000000.0 + Index;
+	return Heartbeat;
+}
+
+int main(int ArgumentCount, char** Arguments)
+{
+	int Scale = ArgumentCount > 1 ? std::max(1, std::atoi(Arguments[1])) : 1;
+
+	FWakaTimeCliSettings Settings;
+	Settings.ConfigPath = "C:\\Users\\Me\\.wakatime.cfg";
+	Settings.LogPath = "C:\\Users\\Me\\.wakatime\\wakatime.log";
+	Settings.ProjectFolder = "C:\\Projects\\My Game\\";
+	Settings.Plugin = "unreal-wakatime/1.2.6";
+
+	std::vector<FWakaTimeHeartbeat> Batch;
+	for (int Index = 0; Index < 50; Index++)
+	{
+		Batch.push_back(MakeHeartbeat(Index));
+	}
+
+	// the same few assets touched over and over, the common case while editing
+	{
+		FWakaTimeDispatchQueue Queue;
+		Measure("Enqueue, merged into 8 waiting", 200000 * Scale, [&Queue](int Iteration)
+		{
+			GSink += static_cast<size_t>(Queue.Enqueue(MakeHeartbeat(Iteration % 8), Iteration));
+		});
+	}
+
+	// every event is a new entity and the informational lane is full
+	{
+		FWakaTimeDispatchQueue Queue;
+		Measure("Enqueue, shedding from a full lane", 50000 * Scale, [&Queue](int Iteration)
+		{
+			GSink += static_cast<size_t>(Queue.Enqueue(MakeHeartbeat(Iteration), Iteration));
+		});
+	}
+
+	{
+		FWakaTimeDispatchQueue Queue;
+		FWakaTimeHeartbeat Out;
+		Measure("Enqueue and PopReady", 200000 * Scale, [&Queue, &Out](int Iteration)
+		{
+			Queue.Enqueue(MakeHeartbeat(Iteration, Iteration % 10 == 0), Iteration);
+			GSink += Queue.PopReady(Iteration, false, Out) ? Out.Entity.size() : 0;
+		});
+	}
+
+	Measure("BuildHeartbeats, 1 heartbeat", 100000 * Scale, [&Settings, &Batch](int)
+	{
+		GSink += FWakaTimeCommandBuilder::BuildHeartbeats(Settings, {Batch[0]}).ToCommandLine().size();
+	});
+
+	Measure("BuildHeartbeats, 50 heartbeats", 10000 * Scale, [&Settings, &Batch](int)
+	{
+		FWakaTimeCommand Command = FWakaTimeCommandBuilder::BuildHeartbeats(Settings, Batch);
+		GSink += Command.ToCommandLine().size() + Command.StdinData.size();
+	});
+
+	std::string Json = FWakaTimeJson::ToJson(Batch[0]);
+	Measure("FromJson", 200000 * Scale, [&Json](int)
+	{
+		FWakaTimeHeartbeat Heartbeat;
+		GSink += FWakaTimeJson::FromJson(Json, Heartbeat) ? Heartbeat.Entity.size() : 0;
+	});
+
+	std::string ConfigText = "[settings]\napi_key = waka_00000000-0000-0000-0000-000000000000\napi_url = https://wakatime.com/api/v1\n"
+		"ignore =\n    COMMIT_EDITMSG$\n    TAG_EDITMSG$\n[unreal]\ntoday_interval = 300\nPieStarted.category = testing\n";
+	Measure("Config Parse and Get", 100000 * Scale, [&ConfigText](int)
+	{
+		FWakaTimeConfig Config;
+		Config.Parse(ConfigText);
+		GSink += Config.Get("settings", "api_key").size();
+	});
+
+	std::printf("(%zu)\n", GSink);
+	return 0;
+}
@@ -0,0 +1,486 @@
+// Unit tests of the engine independent core; built by Source/WakaTimeCore/CMakeLists.txt, not by UnrealBuildTool.
+// Run with ctest, or run the executable directly to see every failed check.
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "WakaTimeCliManifest.h"
+#include "WakaTimeCommand.h"
+#include "WakaTimeConfig.h"
+#include "WakaTimeDispatchQueue.h"
+#include "WakaTimeEventPolicy.h"
+#include "WakaTimeJson.h"
+#include "WakaTimeSessionPacer.h"
+
+static int GNumChecks = 0;
+static int GNumFailed = 0;
+
+#define WAKA_CHECK(Condition) \
+	do \
+	{ \
+		GNumChecks++; \
+		if (!(Condition)) \
+		{ \
+			GNumFailed++; \
+			std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Condition); \
+		} \
+	} while (false)
+
+static FWakaTimeHeartbeat MakeHeartbeat(const std::string& Entity, double Time, bool bFileSave = false)
+{
+	FWakaTimeHeartbeat Heartbeat;
+	Heartbeat.Activity = "designing";
+	Heartbeat.EntityType = "file";
+	Heartbeat.Entity = Entity;
+	Heartbeat.Language = "Unreal Editor";
+	Heartbeat.Project = "Game";
+	Heartbeat.bFileSave = bFileSave;
+	Heartbeat.Time = Time;
+	return Heartbeat;
+}
+
+static FWakaTimeCliSettings MakeSettings()
+{
+	FWakaTimeCliSettings Settings;
+	Settings.ConfigPath = "C:\\Users\\Me\\.wakatime.cfg";
+	Settings.LogPath = "C:\\Users\\Me\\.wakatime\\wakatime.log";
+	Settings.ProjectFolder = "C:\\Projects\\My Game\\";
+	Settings.Plugin = "unreal-wakatime/1.2.6";
+	return Settings;
+}
+
+static bool Contains(const std::vector<std::string>& Arguments, const std::string& Argument)
+{
+	for (const std::string& Each : Arguments)
+	{
+		if (Each == Argument)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static std::string ValueAfter(const std::vector<std::string>& Arguments, const std::string& Flag)
+{
+	for (size_t Index = 0; Index + 1 < Arguments.size(); Index++)
+	{
+		if (Arguments[Index] == Flag)
+		{
+			return Arguments[Index + 1];
+		}
+	}
+	return "";
+}
+
+static void TestQuoteArgument()
+{
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("plain") == "plain");
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("") == "\"\"");
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("with space") == "\"with space\"");
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("C:\\Path\\") == "C:\\Path\\");
+	// a trailing backslash inside quotes has to be doubled, or it escapes the closing quote
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("C:\\My Path\\") == "\"C:\\My Path\\\\\"");
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("say \"hi\"") == "\"say \\\"hi\\\"\"");
+	WAKA_CHECK(FWakaTimeCommandBuilder::QuoteArgument("a\\\"b") == "\"a\\\\\\\"b\"");
+}
+
+static void TestBuildHeartbeats()
+{
+	FWakaTimeCliSettings Settings = MakeSettings();
+
+	WAKA_CHECK(FWakaTimeCommandBuilder::BuildHeartbeats(Settings, {}).Arguments.empty());
+
+	FWakaTimeCommand Single = FWakaTimeCommandBuilder::BuildHeartbeats(Settings, {MakeHeartbeat("Map.umap", 100.5, true)});
+	WAKA_CHECK(ValueAfter(Single.Arguments, "--entity") == "Map.umap");
+	WAKA_CHECK(ValueAfter(Single.Arguments, "--category") == "designing");
+	WAKA_CHECK(ValueAfter(Single.Arguments, "--time") == "100.500");
+	WAKA_CHECK(ValueAfter(Single.Arguments, "--project-folder") == Settings.ProjectFolder);
+	WAKA_CHECK(Contains(Single.Arguments, "--write"));
+	WAKA_CHECK(!Contains(Single.Arguments, "--api-url"));
+	WAKA_CHECK(!Contains(Single.Arguments, "--extra-heartbeats"));
+	WAKA_CHECK(Single.StdinData.empty());
+	WAKA_CHECK(Single.ToCommandLine().find("\"C:\\Projects\\My Game\\\\\"") != std::string::npos);
+
+	Settings.ApiUrl = "https://wakatime.example/api/v1";
+	FWakaTimeCommand Batch = FWakaTimeCommandBuilder::BuildHeartbeats(
+		Settings, {MakeHeartbeat("A.uasset", 1.0), MakeHeartbeat("B.uasset", 2.0), MakeHeartbeat("C.uasset", 3.0)});
+	WAKA_CHECK(ValueAfter(Batch.Arguments, "--api-url") == Settings.ApiUrl);
+	WAKA_CHECK(ValueAfter(Batch.Arguments, "--entity") == "A.uasset");
+	WAKA_CHECK(!Contains(Batch.Arguments, "--write"));
+	WAKA_CHECK(Contains(Batch.Arguments, "--extra-heartbeats"));
+	WAKA_CHECK(Batch.StdinData.find("A.uasset") == std::string::npos);
+	WAKA_CHECK(Batch.StdinData.find("B.uasset") != std::string::npos);
+	WAKA_CHECK(Batch.StdinData.find("C.uasset") != std::string::npos);
+}
+
+static void TestToday()
+{
+	FWakaTimeCommand Today = FWakaTimeCommandBuilder::BuildToday(MakeSettings());
+	WAKA_CHECK(Contains(Today.Arguments, "--today"));
+	WAKA_CHECK(!Contains(Today.Arguments, "--entity"));
+
+	WAKA_CHECK(FWakaTimeCommandBuilder::ParseTodayOutput("  3 hrs 12 mins \r\nsecond line") == "3 hrs 12 mins");
+	WAKA_CHECK(FWakaTimeCommandBuilder::ParseTodayOutput(" \r\n ").empty());
+}
+
+static void TestJson()
+{
+	FWakaTimeHeartbeat Heartbeat = MakeHeartbeat("C:\\Content\\\"Quoted\"\tMap.umap", 1760000000.25, true);
+	Heartbeat.Project = "Spiel \xC3\xBC\n";
+
+	std::string Json = FWakaTimeJson::ToJson(Heartbeat);
+	WAKA_CHECK(Json.find('\n') == std::string::npos);
+
+	FWakaTimeHeartbeat Parsed;
+	WAKA_CHECK(FWakaTimeJson::FromJson(Json, Parsed));
+	WAKA_CHECK(Parsed.Entity == Heartbeat.Entity);
+	WAKA_CHECK(Parsed.Project == Heartbeat.Project);
+	WAKA_CHECK(Parsed.IsSameActivity(Heartbeat));
+	WAKA_CHECK(std::fabs(Parsed.Time - Heartbeat.Time) < 0.001);
+
+	FWakaTimeHeartbeat Control;
+	WAKA_CHECK(FWakaTimeJson::FromJson("{\"entity\":\"a\\u0001b\",\"unknown\":null , \"is_write\" : false}", Control));
+	WAKA_CHECK(Control.Entity == std::string("a\x01" "b"));
+	WAKA_CHECK(!Control.bFileSave);
+
+	WAKA_CHECK(!FWakaTimeJson::FromJson("", Control));
+	WAKA_CHECK(!FWakaTimeJson::FromJson("{\"entity\":\"unterminated", Control));
+	WAKA_CHECK(!FWakaTimeJson::FromJson("[1]", Control));
+
+	std::vector<FWakaTimeHeartbeat> Heartbeats = {MakeHeartbeat("A", 1.0), MakeHeartbeat("B", 2.0)};
+	WAKA_CHECK(FWakaTimeJson::ToJsonArray(Heartbeats, 2) == "[]");
+	WAKA_CHECK(FWakaTimeJson::ToJsonArray(Heartbeats) == "[" + FWakaTimeJson::ToJson(Heartbeats[0]) + "," +
+		FWakaTimeJson::ToJson(Heartbeats[1]) + "]");
+}
+
+static void TestConfig()
+{
+	const std::string Text =
+		"; shared with the cli\n"
+		"[settings]\n"
+		"api_key = old-key\n"
+		"ignore =\n"
+		"    COMMIT_EDITMSG$\n"
+		"    TAG_EDITMSG$\n"
+		"\n"
+		"[unreal]\n"
+		"today_interval = 600\n"
+		"debug = yes\n";
+
+	FWakaTimeConfig Config;
+	Config.Parse(Text);
+	WAKA_CHECK(Config.Serialize() == Text);
+	WAKA_CHECK(Config.Get("settings", "api_key") == "old-key");
+	WAKA_CHECK(Config.Get("unreal", "api_key", "none") == "none");
+	WAKA_CHECK(Config.GetDouble("unreal", "today_interval", 0.0) == 600.0);
+	WAKA_CHECK(Config.GetDouble("settings", "api_key", 5.0) == 5.0);
+	WAKA_CHECK(Config.GetBool("unreal", "debug", false));
+
+	WAKA_CHECK(Config.Set("settings", "api_key", "new-key"));
+	WAKA_CHECK(!Config.Set("settings", "api_key", "new-key"));
+	WAKA_CHECK(Config.Set("relay", "relay_url", "tcp://relay:9800"));
+	WAKA_CHECK(Config.Remove("unreal", "debug"));
+	WAKA_CHECK(!Config.Remove("unreal", "debug"));
+
+	const std::string Path = "wakatime-core-tests.cfg";
+	WAKA_CHECK(Config.Save(Path));
+
+	FWakaTimeConfig Loaded;
+	WAKA_CHECK(Loaded.Load(Path));
+	WAKA_CHECK(Loaded.Serialize() == Config.Serialize());
+	WAKA_CHECK(Loaded.Get("settings", "api_key") == "new-key");
+	WAKA_CHECK(Loaded.Get("relay", "relay_url") == "tcp://relay:9800");
+	WAKA_CHECK(!Loaded.Has("unreal", "debug"));
+	WAKA_CHECK(Loaded.Serialize().find("    TAG_EDITMSG$") != std::string::npos);
+	WAKA_CHECK(Loaded.Serialize().find("; shared with the cli") != std::string::npos);
+	std::remove(Path.c_str());
+
+	FWakaTimeConfig Missing;
+	WAKA_CHECK(!Missing.Load("wakatime-core-tests-missing.cfg"));
+	WAKA_CHECK(!Missing.Has("settings", "api_key"));
+}
+
+static void TestEventPolicy()
+{
+	FWakaTimeEventPolicy Default;
+	Default.Category = "designing";
+	Default.MinIntervalSeconds = 30.0;
+
+	FWakaTimeConfig Config;
+	Config.Parse(
+		"[unreal]\n"
+		"PieStarted.enabled = false\n"
+		"PieStarted.sample_rate = 0.25\n"
+		"PieStarted.min_interval = 60\n"
+		"PieStarted.priority = high\n"
+		"PieStarted.category = testing\n"
+		"ActorsDropped.sample_rate = 4\n"
+		"ActorsDeleted.sample_rate = -1\n"
+		"WorldSaved.enabled = maybe\n"
+		"WorldSaved.sample_rate = often\n"
+		"WorldSaved.min_interval = -10\n"
+		"WorldSaved.priority = urgent\n"
+		"AssetOpened.enabled = on\n"
+		"AssetOpened.min_interval = soon\n"
+		"AssetOpened.sample_rate = nan\n"
+		"AssetOpened.flavor = vanilla\n"
+		"[settings]\n"
+		"PieEnded.enabled = false\n");
+
+	FWakaTimeEventPolicy Policy = FWakaTimeEventPolicy::Load(Config, "unreal", "PieStarted", Default);
+	WAKA_CHECK(!Policy.bEnabled);
+	WAKA_CHECK(Policy.SampleRate == 0.25f);
+	WAKA_CHECK(Policy.MinIntervalSeconds == 60.0);
+	WAKA_CHECK(Policy.bHighPriority);
+	WAKA_CHECK(Policy.Category == "testing");
+
+	WAKA_CHECK(FWakaTimeEventPolicy::Load(Config, "unreal", "ActorsDropped", Default).SampleRate == 1.0f);
+	WAKA_CHECK(FWakaTimeEventPolicy::Load(Config, "unreal", "ActorsDeleted", Default).SampleRate == 0.0f);
+
+	// values that mean nothing keep the default
+	Policy = FWakaTimeEventPolicy::Load(Config, "unreal", "WorldSaved", Default);
+	WAKA_CHECK(Policy.bEnabled);
+	WAKA_CHECK(Policy.SampleRate == 1.0f);
+	WAKA_CHECK(Policy.MinIntervalSeconds == 30.0);
+	WAKA_CHECK(!Policy.bHighPriority);
+	WAKA_CHECK(Policy.Category == "designing");
+
+	Policy = FWakaTimeEventPolicy::Load(Config, "unreal", "AssetOpened", Default);
+	WAKA_CHECK(Policy.bEnabled);
+	WAKA_CHECK(Policy.MinIntervalSeconds == 30.0);
+	WAKA_CHECK(Policy.SampleRate == 1.0f);
+
+	// "normal" turns a high priority default off
+	FWakaTimeEventPolicy Urgent = Default;
+	Urgent.bHighPriority = true;
+	FWakaTimeConfig Normal;
+	Normal.Parse("[unreal]\nWorldSaved.priority = normal\n");
+	WAKA_CHECK(!FWakaTimeEventPolicy::Load(Normal, "unreal", "WorldSaved", Urgent).bHighPriority);
+	WAKA_CHECK(FWakaTimeEventPolicy::Load(Normal, "unreal", "PieStarted", Urgent).bHighPriority);
+
+	// other sections and events are not read
+	Policy = FWakaTimeEventPolicy::Load(Config, "unreal", "PieEnded", Default);
+	WAKA_CHECK(Policy.bEnabled && Policy.SampleRate == 1.0f && Policy.MinIntervalSeconds == 30.0 &&
+		!Policy.bHighPriority && Policy.Category == "designing");
+}
+
+static void TestCliManifestVersions()
+{
+	WAKA_CHECK(FWakaTimeCliManifest::IsNewerVersion("v1.100.0", "v1.99.2"));
+	WAKA_CHECK(FWakaTimeCliManifest::IsNewerVersion("1.99.3", "v1.99.2"));
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("v1.99.2", "1.99.2"));
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("v1.98.0", "v1.99.2"));
+
+	// missing components count as zero
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("v1.99", "v1.99.0"));
+	WAKA_CHECK(FWakaTimeCliManifest::IsNewerVersion("v1.99.0.1", "v1.99"));
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("v2", "v2.0.1"));
+
+	// a pre-release suffix is ignored, so it never replaces the release it leads up to
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("v1.99.0-rc.1", "v1.99.0"));
+	WAKA_CHECK(FWakaTimeCliManifest::IsNewerVersion("v1.100.0-beta", "v1.99.0"));
+
+	// anything beats an unknown installed version, nothing beats it with an unknown candidate
+	WAKA_CHECK(FWakaTimeCliManifest::IsNewerVersion("v1.0.0", ""));
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("", "v1.0.0"));
+	WAKA_CHECK(!FWakaTimeCliManifest::IsNewerVersion("latest", ""));
+
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"id\": 1, \"tag_name\": \"v1.99.2\", \"name\": \"\"}") == "v1.99.2");
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"tag_name\":\n  \"v1.99.2\"}") == "v1.99.2");
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"message\": \"Not Found\"}").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"tag_name\": null}").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"tag_name\": \"v1.99").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"tag_name\": \"nightly\"}").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag("{\"tag_name\": \"v1.\\\"99\"}").empty());
+
+	// the release notes quoting another release come first in the text, the real key after them
+	WAKA_CHECK(FWakaTimeCliManifest::ParseReleaseTag(
+		"{\"body\": \"like \\\"tag_name\\\": \\\"v9.9.9\\\"\", \"tag_name\": \"v1.99.2\"}") == "v1.99.2");
+
+	WAKA_CHECK(FWakaTimeCliManifest::ParseVersionOutput("v1.99.2\n") == "v1.99.2");
+	WAKA_CHECK(FWakaTimeCliManifest::ParseVersionOutput("  1.99.2 (windows/amd64)\r\n") == "1.99.2");
+	WAKA_CHECK(FWakaTimeCliManifest::ParseVersionOutput("").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseVersionOutput(" \r\n").empty());
+	WAKA_CHECK(FWakaTimeCliManifest::ParseVersionOutput("Error: unknown flag --version").empty());
+}
+
+static void TestCliManifest()
+{
+	FWakaTimeCliManifest Manifest;
+	Manifest.LastCheckTime = 1000.0;
+	WAKA_CHECK(!Manifest.IsCheckDue(1500.0, 3600.0));
+	WAKA_CHECK(Manifest.IsCheckDue(4600.0, 3600.0));
+	WAKA_CHECK(Manifest.IsCheckDue(1000.0, 0.0));
+	WAKA_CHECK(Manifest.IsCheckDue(1000.0, -5.0));
+
+	// a clock that went backwards does not postpone the check until it catches up again
+	WAKA_CHECK(Manifest.IsCheckDue(500.0, 3600.0));
+
+	FWakaTimeCliManifest Never;
+	WAKA_CHECK(Never.IsCheckDue(1700000000.0, 3600.0));
+
+	const std::string Path = "wakatime-core-tests.manifest";
+	std::remove(Path.c_str());
+
+	FWakaTimeCliManifest Amd64;
+	Amd64.Version = "v1.99.2";
+	Amd64.Checksum = "1a2b3c";
+	Amd64.LastCheckTime = 1700000000.0;
+	WAKA_CHECK(Amd64.Save(Path, "wakatime-cli-windows-amd64.exe"));
+
+	FWakaTimeCliManifest Arm64;
+	Arm64.Version = "v1.98.0";
+	Arm64.Checksum = "4d5e6f";
+	Arm64.LastCheckTime = 1690000000.0;
+	WAKA_CHECK(Arm64.Save(Path, "wakatime-cli-windows-arm64.exe"));
+
+	// saving one binary keeps the section of the other
+	FWakaTimeCliManifest Loaded;
+	WAKA_CHECK(Loaded.Load(Path, "wakatime-cli-windows-amd64.exe"));
+	WAKA_CHECK(Loaded.Version == "v1.99.2" && Loaded.Checksum == "1a2b3c" && Loaded.LastCheckTime == 1700000000.0);
+	WAKA_CHECK(Loaded.Load(Path, "wakatime-cli-windows-arm64.exe"));
+	WAKA_CHECK(Loaded.Version == "v1.98.0" && Loaded.Checksum == "4d5e6f" && Loaded.LastCheckTime == 1690000000.0);
+
+	Amd64.Version = "v1.100.0";
+	WAKA_CHECK(Amd64.Save(Path, "wakatime-cli-windows-amd64.exe"));
+	WAKA_CHECK(Loaded.Load(Path, "wakatime-cli-windows-amd64.exe") && Loaded.Version == "v1.100.0");
+	WAKA_CHECK(Loaded.Load(Path, "wakatime-cli-windows-arm64.exe") && Loaded.Version == "v1.98.0");
+
+	// an unknown binary gets an empty manifest, so it is checked right away
+	WAKA_CHECK(Loaded.Load(Path, "wakatime-cli-linux-amd64"));
+	WAKA_CHECK(Loaded.Version.empty() && Loaded.Checksum.empty() && Loaded.LastCheckTime == 0.0);
+	std::remove(Path.c_str());
+
+	WAKA_CHECK(!Loaded.Load("wakatime-core-tests-missing.manifest", "wakatime-cli-windows-amd64.exe"));
+	WAKA_CHECK(Loaded.Version.empty());
+}
+
+static void TestDispatchQueueMerge()
+{
+	FWakaTimeDispatchQueue Queue(30.0);
+
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("A", 1.0), 0.0) == EWakaTimeEnqueueResult::Queued);
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("A", 5.0), 1.0) == EWakaTimeEnqueueResult::Merged);
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("A", 2.0), 2.0) == EWakaTimeEnqueueResult::Merged);
+	WAKA_CHECK(Queue.Num() == 1);
+
+	// busy and not overdue: held back
+	FWakaTimeHeartbeat Out;
+	WAKA_CHECK(!Queue.PopReady(10.0, true, Out));
+	WAKA_CHECK(!Queue.IsOldestOverdue(10.0));
+	WAKA_CHECK(Queue.IsOldestOverdue(30.0));
+
+	WAKA_CHECK(Queue.PopReady(11.0, false, Out));
+	WAKA_CHECK(Out.Entity == "A");
+	WAKA_CHECK(Out.Time == 5.0); // moved forward to the latest merged time
+	WAKA_CHECK(Queue.IsEmpty());
+	WAKA_CHECK(Queue.GetStats().NumMerged == 2);
+	WAKA_CHECK(Queue.GetStats().NumDeferred == 1);
+
+	// busy but overdue: forced out
+	Queue.Enqueue(MakeHeartbeat("B", 20.0), 20.0);
+	WAKA_CHECK(Queue.PopReady(50.0, true, Out));
+	WAKA_CHECK(Out.Entity == "B");
+	WAKA_CHECK(Queue.GetStats().NumForcedByMaxDelay == 1);
+}
+
+static void TestDispatchQueueLanes()
+{
+	FWakaTimeDispatchQueue Queue(30.0, 2, 3);
+	size_t SlotBytes = Queue.GetSlotBytes();
+
+	// saves are released first and regardless of the editor being busy
+	Queue.Enqueue(MakeHeartbeat("Info", 1.0), 0.0);
+	Queue.Enqueue(MakeHeartbeat("Save", 2.0, true), 1.0);
+	FWakaTimeHeartbeat Out;
+	WAKA_CHECK(Queue.IsOldestOverdue(1.0));
+	WAKA_CHECK(Queue.PopReady(1.0, true, Out));
+	WAKA_CHECK(Out.Entity == "Save" && Out.bFileSave);
+	WAKA_CHECK(!Queue.PopReady(1.0, true, Out));
+	WAKA_CHECK(Queue.PopReady(1.0, false, Out));
+	WAKA_CHECK(Out.Entity == "Info");
+
+	// a full informational lane sheds its oldest heartbeat
+	Queue.Enqueue(MakeHeartbeat("I1", 1.0), 2.0);
+	Queue.Enqueue(MakeHeartbeat("I2", 2.0), 3.0);
+	Queue.Enqueue(MakeHeartbeat("I3", 3.0), 4.0);
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("I4", 4.0), 5.0) == EWakaTimeEnqueueResult::ShedOldest);
+	WAKA_CHECK(Queue.GetStats().NumShed == 1);
+
+	// a full write lane never sheds; the caller has to keep the save
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("S1", 1.0, true), 6.0) == EWakaTimeEnqueueResult::Queued);
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("S2", 2.0, true), 7.0) == EWakaTimeEnqueueResult::Queued);
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("S3", 3.0, true), 8.0) == EWakaTimeEnqueueResult::WriteLaneFull);
+	WAKA_CHECK(Queue.Enqueue(MakeHeartbeat("S1", 9.0, true), 9.0) == EWakaTimeEnqueueResult::Merged);
+	WAKA_CHECK(Queue.GetStats().NumWriteOverflows == 1);
+	WAKA_CHECK(Queue.GetStats().PeakWrite == 2);
+	WAKA_CHECK(Queue.GetStats().PeakInfo == 3);
+	WAKA_CHECK(Queue.Num() == 5);
+	WAKA_CHECK(Queue.GetSlotBytes() == SlotBytes);
+
+	// oldest first across both lanes
+	std::vector<FWakaTimeHeartbeat> All = Queue.TakeAll();
+	WAKA_CHECK(All.size() == 5);
+	WAKA_CHECK(All.size() == 5 && All[0].Entity == "I2" && All[2].Entity == "I4" && All[3].Entity == "S1" &&
+		All[4].Entity == "S2");
+	WAKA_CHECK(Queue.IsEmpty());
+
+	// the ring keeps working after wrapping around
+	for (int Round = 0; Round < 10; Round++)
+	{
+		Queue.Enqueue(MakeHeartbeat("R" + std::to_string(Round), Round), Round);
+		WAKA_CHECK(Queue.PopReady(Round, false, Out));
+		WAKA_CHECK(Out.Entity == "R" + std::to_string(Round));
+	}
+}
+
+static void TestSessionPacer()
+{
+	FWakaTimeSessionPacer Pacer(120.0);
+	WAKA_CHECK(!Pacer.IsActive());
+	WAKA_CHECK(Pacer.Advance(1000.0).empty());
+
+	Pacer.Start(1000.0);
+	WAKA_CHECK(Pacer.IsActive());
+	WAKA_CHECK(Pacer.Advance(1100.0).empty());
+
+	std::vector<double> Times = Pacer.Advance(1200.0);
+	WAKA_CHECK(Times.size() == 1 && Times[0] == 1120.0);
+
+	// a long stall (e.g. a breakpoint) yields every missed interval
+	Times = Pacer.Advance(1590.0);
+	WAKA_CHECK(Times.size() == 3 && Times[0] == 1240.0 && Times[2] == 1480.0);
+
+	Times = Pacer.Stop(1650.0);
+	WAKA_CHECK(Times.size() == 2 && Times[0] == 1600.0 && Times[1] == 1650.0);
+	WAKA_CHECK(!Pacer.IsActive());
+	WAKA_CHECK(Pacer.Stop(2000.0).empty());
+
+	// stopping right on an interval does not report the same time twice
+	Pacer.Start(0.0);
+	Times = Pacer.Stop(120.0);
+	WAKA_CHECK(Times.size() == 1 && Times[0] == 120.0);
+}
+
+int main()
+{
+	TestQuoteArgument();
+	TestBuildHeartbeats();
+	TestToday();
+	TestJson();
+	TestConfig();
+	TestEventPolicy();
+	TestCliManifestVersions();
+	TestCliManifest();
+	TestDispatchQueueMerge();
+	TestDispatchQueueLanes();
+	TestSessionPacer();
+
+	std::printf("%d checks, %d failed\n", GNumChecks, GNumFailed);
+	return GNumFailed == 0 ? 0 : 1;
+}
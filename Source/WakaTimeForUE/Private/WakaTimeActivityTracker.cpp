@@ -0,0 +1,193 @@
+#include "WakaTimeActivityTracker.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "Misc/PackageName.h"
+
+// Actors and objects saved one file per object (World Partition) live in
+// /<Mount>/__ExternalActors__/<Map path>/<hash folder>/<hash folder>/<object>; they are reported as the map they belong to.
+// Returns an empty path for packages without a file on disk (/Script/, /Memory/ or an unmapped mount point)
+static FString GetReportedFilePath(const UPackage* Package)
+{
+	FString PackageName = Package->GetName();
+	FString FilePath;
+
+	if (PackageName.StartsWith(TEXT("/Script/")) || PackageName.StartsWith(TEXT("/Memory/")))
+	{
+		return FilePath;
+	}
+
+	for (const TCHAR* ExternalFolder : {TEXT("/__ExternalActors__/"), TEXT("/__ExternalObjects__/")})
+	{
+		int32 FolderStart = PackageName.Find(ExternalFolder, ESearchCase::CaseSensitive);
+		if (FolderStart == INDEX_NONE)
+		{
+			continue;
+		}
+
+		FString MapPackageName = PackageName.Left(FolderStart + 1) + PackageName.Mid(FolderStart + FCString::Strlen(ExternalFolder));
+		for (int32 Segment = 0; Segment < 3; Segment++)
+		{
+			int32 LastSlash;
+			if (MapPackageName.FindLastChar(TEXT('/'), LastSlash))
+			{
+				MapPackageName.LeftInline(LastSlash);
+			}
+		}
+		FPackageName::TryConvertLongPackageNameToFilename(MapPackageName, FilePath, FPackageName::GetMapPackageExtension());
+		return FilePath;
+	}
+
+	// unlike LongPackageNameToFilename this does not assert on a root that is not mounted
+	FPackageName::TryConvertLongPackageNameToFilename(PackageName, FilePath, Package->ContainsMap()
+		                                                                    ? FPackageName::GetMapPackageExtension()
+		                                                                    : FPackageName::GetAssetPackageExtension());
+	return FilePath;
+}
+
+void FWakaTimeActivityTracker::Initialize(TFunction<void(const FString&, double)> InOnActivity, double InIntervalSeconds)
+{
+	OnActivity = MoveTemp(InOnActivity);
+	IntervalSeconds = InIntervalSeconds;
+	IntervalStart = FPlatformTime::Seconds();
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeActivityTracker::Tick));
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeActivityTracker::Tick));
+#endif
+}
+
+void FWakaTimeActivityTracker::Shutdown()
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	Flush();
+	LogStats();
+}
+
+void FWakaTimeActivityTracker::MarkPackage(const UPackage* Package)
+{
+	NumMarks++;
+
+	FObjectKey Key(Package);
+	if (Key == LastMarked)
+	{
+		return;
+	}
+
+	if (!Package || Package == GetTransientPackage() || Package->HasAnyPackageFlags(PKG_PlayInEditor | PKG_CompiledIn))
+	{
+		return;
+	}
+
+	LastMarked = Key;
+
+	uint32 Slot = GetTypeHash(Key) & (FrameSlots - 1);
+	for (int32 Probe = 0; Probe < FrameSlots; Probe++)
+	{
+		if (FrameMarks[Slot] == Key)
+		{
+			return;
+		}
+
+		if (FrameMarks[Slot] == FObjectKey())
+		{
+			FrameMarks[Slot] = Key;
+			NumFrameMarks++;
+			return;
+		}
+
+		Slot = (Slot + 1) & (FrameSlots - 1);
+	}
+
+	// more distinct packages than slots in one frame; they were most likely touched by a tool, not a user
+	NumFrameOverflows++;
+}
+
+void FWakaTimeActivityTracker::FoldFrame()
+{
+	LastMarked = FObjectKey();
+
+	if (NumFrameMarks == 0)
+	{
+		return;
+	}
+
+	double Now = FWakaTimeHeartbeatScheduler::Now();
+	for (FObjectKey& Key : FrameMarks)
+	{
+		if (Key == FObjectKey())
+		{
+			continue;
+		}
+
+		// the package may have been garbage collected since it was marked
+		if (const UPackage* Package = Cast<UPackage>(Key.ResolveObjectPtr()))
+		{
+			FTouchedPackage* Touched = IntervalPackages.Find(Package->GetFName());
+			if (!Touched)
+			{
+				// kept even without a file path, so the path is not looked up again this interval
+				Touched = &IntervalPackages.Add(Package->GetFName());
+				Touched->FilePath = GetReportedFilePath(Package);
+			}
+			Touched->LastTime = Now;
+		}
+
+		Key = FObjectKey();
+	}
+
+	NumFrameMarks = 0;
+}
+
+void FWakaTimeActivityTracker::Flush()
+{
+	FoldFrame();
+
+	// several packages can belong to the same file (e.g. every actor of a World Partition map)
+	TMap<FString, double> TouchedFiles;
+	for (const TPair<FName, FTouchedPackage>& Pair : IntervalPackages)
+	{
+		if (Pair.Value.FilePath.IsEmpty())
+		{
+			continue;
+		}
+
+		double& LastTime = TouchedFiles.FindOrAdd(Pair.Value.FilePath, 0.0);
+		LastTime = FMath::Max(LastTime, Pair.Value.LastTime);
+	}
+
+	for (const TPair<FString, double>& Pair : TouchedFiles)
+	{
+		OnActivity(Pair.Key, Pair.Value);
+		NumReports++;
+	}
+
+	IntervalPackages.Reset();
+	IntervalStart = FPlatformTime::Seconds();
+}
+
+void FWakaTimeActivityTracker::LogStats() const
+{
+	UE_LOG(LogWakaTime, Log, TEXT("Activity tracker: %llu marks, %llu frame overflows, %llu package reports"), NumMarks,
+	       NumFrameOverflows, NumReports);
+}
+
+bool FWakaTimeActivityTracker::Tick(float DeltaTime)
+{
+	FoldFrame();
+
+	if (FPlatformTime::Seconds() - IntervalStart >= IntervalSeconds)
+	{
+		Flush();
+	}
+
+	return true;
+}
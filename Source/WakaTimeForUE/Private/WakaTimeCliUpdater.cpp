@@ -0,0 +1,376 @@
+#include "WakaTimeCliUpdater.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeCliManifest.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "Async/Async.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/SecureHash.h"
+
+// How often the ticker checks whether a check finished or is due; the manifest is read at this rate
+static constexpr float GCliUpdateTickSeconds = 60.0f;
+
+static const TCHAR* GCliReleaseUrl = TEXT("https://api.github.com/repos/wakatime/wakatime-cli/releases/latest");
+
+static const TCHAR* GPowershellPath = TEXT("C:\\Windows\\System32\\WindowsPowerShell\\v1.0\\powershell.exe");
+
+// Single quoted powershell string; a quote inside is doubled
+static FString QuotePowershell(const FString& Value)
+{
+	return TEXT("'") + Value.Replace(TEXT("'"), TEXT("''")) + TEXT("'");
+}
+
+static FString GetCliManifestPath(const FString& CliDirectory)
+{
+	return CliDirectory / TEXT("wakatime-cli.manifest");
+}
+
+static FString GetCliChecksum(const FString& ExePath)
+{
+	return LexToString(FMD5Hash::HashFile(*ExePath));
+}
+
+void FWakaTimeCliUpdater::Initialize(const FString& InCliDirectory, const FString& InExeName, const FString& InArchitecture,
+                                     double InIntervalSeconds)
+{
+	CliDirectory = InCliDirectory;
+	ExeName = InExeName;
+	Architecture = InArchitecture;
+	IntervalSeconds = InIntervalSeconds;
+
+	if (IntervalSeconds <= 0.0)
+	{
+		UE_LOG(LogWakaTime, Log, TEXT("wakatime-cli update checks are disabled"));
+		return;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeCliUpdater::Tick), GCliUpdateTickSeconds);
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeCliUpdater::Tick), GCliUpdateTickSeconds);
+#endif
+}
+
+void FWakaTimeCliUpdater::Shutdown()
+{
+	if (IntervalSeconds <= 0.0)
+	{
+		return;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	if (Running.IsValid())
+	{
+		// the running process is terminated and the task skips every step after it, including the swap
+		Running->bCancel = true;
+		RunningTask.Wait();
+		Running.Reset();
+	}
+
+	LogStats();
+}
+
+void FWakaTimeCliUpdater::LogStats() const
+{
+	UE_LOG(LogWakaTime, Log, TEXT("wakatime-cli updates: %u checks, %u updates installed, %u failed"), NumChecks, NumUpdates,
+	       NumFailed);
+}
+
+bool FWakaTimeCliUpdater::Tick(float DeltaTime)
+{
+	if (Running.IsValid())
+	{
+		if (Running->bDone)
+		{
+			FinishCheck();
+		}
+		return true;
+	}
+
+	// other editors on the machine may have checked meanwhile
+	FWakaTimeCliManifest Manifest;
+	Manifest.Load(TCHAR_TO_UTF8(*GetCliManifestPath(CliDirectory)), TCHAR_TO_UTF8(*ExeName));
+	if (Manifest.IsCheckDue(FWakaTimeHeartbeatScheduler::Now(), IntervalSeconds))
+	{
+		StartCheck();
+	}
+	return true;
+}
+
+void FWakaTimeCliUpdater::StartCheck()
+{
+	NumChecks++;
+
+	TSharedRef<FCheck, ESPMode::ThreadSafe> Check = MakeShared<FCheck, ESPMode::ThreadSafe>();
+	Running = Check;
+
+	FString TaskCliDirectory = CliDirectory;
+	FString TaskExeName = ExeName;
+	FString TaskArchitecture = Architecture;
+	double TaskIntervalSeconds = IntervalSeconds;
+	RunningTask = Async(EAsyncExecution::ThreadPool,
+	                    [TaskCliDirectory, TaskExeName, TaskArchitecture, TaskIntervalSeconds, Check]()
+	                    {
+		                    RunCheck(TaskCliDirectory, TaskExeName, TaskArchitecture, TaskIntervalSeconds, Check);
+	                    });
+}
+
+void FWakaTimeCliUpdater::FinishCheck()
+{
+	FString Result;
+	bool bUpdated;
+	bool bFailed;
+	{
+		FScopeLock ScopeLock(&Running->Lock);
+		Result = Running->Result;
+		bUpdated = Running->bUpdated;
+		bFailed = Running->bFailed;
+	}
+	Running.Reset();
+
+	if (bFailed)
+	{
+		// the installed cli keeps working; the next check is an interval away
+		UE_LOG(LogWakaTime, Warning, TEXT("wakatime-cli update check failed: %s"), *Result);
+		NumFailed++;
+		return;
+	}
+
+	UE_LOG(LogWakaTime, Log, TEXT("wakatime-cli %s"), *Result);
+	if (bUpdated)
+	{
+		NumUpdates++;
+	}
+}
+
+void FWakaTimeCliUpdater::RunCheck(const FString& TaskCliDirectory, const FString& TaskExeName,
+                                   const FString& TaskArchitecture, double TaskIntervalSeconds,
+                                   const TSharedRef<FCheck, ESPMode::ThreadSafe>& Check)
+{
+	auto Finish = [&Check](const FString& Result, bool bUpdated, bool bFailed)
+	{
+		{
+			FScopeLock ScopeLock(&Check->Lock);
+			Check->Result = Result;
+			Check->bUpdated = bUpdated;
+			Check->bFailed = bFailed;
+		}
+		Check->bDone = true;
+	};
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	std::string ManifestPath = TCHAR_TO_UTF8(*GetCliManifestPath(TaskCliDirectory));
+	std::string ManifestSection = TCHAR_TO_UTF8(*TaskExeName);
+	FString ExePath = TaskCliDirectory / TaskExeName;
+
+	FWakaTimeCliManifest Manifest;
+	Manifest.Load(ManifestPath, ManifestSection);
+	double Now = FWakaTimeHeartbeatScheduler::Now();
+	if (!Manifest.IsCheckDue(Now, TaskIntervalSeconds))
+	{
+		Finish(TEXT("was checked by another editor"), false, false);
+		return;
+	}
+
+	// claimed before the slow part, so editors starting together do not all download the same release
+	Manifest.LastCheckTime = Now;
+	Manifest.Save(ManifestPath, ManifestSection);
+
+	// the binary is shared with other IDEs, which may have replaced it since the manifest was written
+	FString Checksum = GetCliChecksum(ExePath);
+	if (Manifest.Version.empty() || Manifest.Checksum != TCHAR_TO_UTF8(*Checksum))
+	{
+		Manifest.Version = GetBinaryVersion(ExePath, *Check);
+		Manifest.Checksum = TCHAR_TO_UTF8(*Checksum);
+		Manifest.Save(ManifestPath, ManifestSection);
+	}
+
+	// Invoke-WebRequest sends a user agent, which the GitHub api requires
+	FString ReleasePath = TaskCliDirectory / TEXT("wakatime-cli-release.json");
+	FString ReleaseOutput;
+	bool bFetched = RunPowershell(FString::Printf(TEXT("Invoke-WebRequest -UseBasicParsing -Uri %s -OutFile %s"),
+	                                              *QuotePowershell(GCliReleaseUrl), *QuotePowershell(ReleasePath)),
+	                              *Check, ReleaseOutput);
+
+	// powershell has exited (or was terminated) by now, nothing writes the file anymore
+	FString ReleaseJson;
+	if (bFetched)
+	{
+		FFileHelper::LoadFileToString(ReleaseJson, *ReleasePath);
+	}
+	PlatformFile.DeleteFile(*ReleasePath);
+
+	if (Check->bCancel)
+	{
+		Finish(TEXT("check cancelled"), false, false);
+		return;
+	}
+
+	std::string LatestTag = FWakaTimeCliManifest::ParseReleaseTag(TCHAR_TO_UTF8(*ReleaseJson));
+	if (LatestTag.empty())
+	{
+		Finish(FString::Printf(TEXT("could not get the latest release: %s"), *ReleaseOutput.TrimStartAndEnd()), false, true);
+		return;
+	}
+
+	FString Installed = Manifest.Version.empty() ? TEXT("unknown") : FString(UTF8_TO_TCHAR(Manifest.Version.c_str()));
+	FString Latest = UTF8_TO_TCHAR(LatestTag.c_str());
+	if (!FWakaTimeCliManifest::IsNewerVersion(LatestTag, Manifest.Version))
+	{
+		Finish(FString::Printf(TEXT("%s is up to date"), *Installed), false, false);
+		return;
+	}
+
+	// extracted next to the installed binary, so the swap is a rename on the same volume
+	FString ZipPath = TaskCliDirectory / FString::Printf(TEXT("wakatime-cli-%s.zip"), *Latest);
+	FString ExtractDirectory = TaskCliDirectory / FString::Printf(TEXT("wakatime-cli-%s"), *Latest);
+	FString NewExePath = ExtractDirectory / TaskExeName;
+	FString Url = FString::Printf(TEXT("https://github.com/wakatime/wakatime-cli/releases/download/%s/wakatime-cli-windows-%s.zip"),
+	                              *Latest, *TaskArchitecture);
+
+	FString Output;
+	FString Failure;
+	if (!RunPowershell(FString::Printf(TEXT("Invoke-WebRequest -UseBasicParsing -Uri %s -OutFile %s"), *QuotePowershell(Url),
+	                                   *QuotePowershell(ZipPath)), *Check, Output))
+	{
+		Failure = FString::Printf(TEXT("could not download %s: %s"), *Latest, *Output.TrimStartAndEnd());
+	}
+	else if (!RunPowershell(FString::Printf(TEXT("Expand-Archive -Force -Path %s -DestinationPath %s"), *QuotePowershell(ZipPath),
+	                                        *QuotePowershell(ExtractDirectory)), *Check, Output))
+	{
+		Failure = FString::Printf(TEXT("could not extract %s: %s"), *Latest, *Output.TrimStartAndEnd());
+	}
+	else
+	{
+		// a binary that does not report the release it came from is not complete, or not the one that was asked for
+		std::string NewVersion = GetBinaryVersion(NewExePath, *Check);
+		if (NewVersion.empty() || FWakaTimeCliManifest::IsNewerVersion(NewVersion, LatestTag) ||
+			FWakaTimeCliManifest::IsNewerVersion(LatestTag, NewVersion))
+		{
+			Failure = FString::Printf(TEXT("the extracted binary reports \"%s\" instead of %s"), UTF8_TO_TCHAR(NewVersion.c_str()),
+			                          *Latest);
+		}
+		else if (Check->bCancel || !SwapBinary(NewExePath, ExePath))
+		{
+			Failure = FString::Printf(TEXT("could not install %s over %s"), *Latest, *Installed);
+		}
+	}
+
+	PlatformFile.DeleteFile(*ZipPath);
+	PlatformFile.DeleteDirectoryRecursively(*ExtractDirectory);
+
+	if (Check->bCancel && !Failure.IsEmpty())
+	{
+		Finish(TEXT("check cancelled"), false, false);
+		return;
+	}
+	if (!Failure.IsEmpty())
+	{
+		Finish(Failure, false, true);
+		return;
+	}
+
+	Manifest.Version = LatestTag;
+	Manifest.Checksum = TCHAR_TO_UTF8(*GetCliChecksum(ExePath));
+	Manifest.Save(ManifestPath, ManifestSection);
+
+	Finish(FString::Printf(TEXT("updated from %s to %s"), *Installed, *Latest), true, false);
+}
+
+bool FWakaTimeCliUpdater::RunProcess(const FString& ExePath, const FString& Arguments, const FCheck& Check, FString& OutOutput)
+{
+	double StartTime = FPlatformTime::Seconds();
+
+	void* ReadPipe = nullptr;
+	void* WritePipe = nullptr;
+	FPlatformProcess::CreatePipe(ReadPipe, WritePipe);
+
+	OutOutput.Reset();
+	bool bSucceeded = false;
+
+	FProcHandle Process = FPlatformProcess::CreateProc(*ExePath, *Arguments, false, true, true, nullptr, 0, nullptr, WritePipe);
+	if (Process.IsValid())
+	{
+		bool bTerminated = false;
+		while (FPlatformProcess::IsProcRunning(Process))
+		{
+			OutOutput += FPlatformProcess::ReadPipe(ReadPipe);
+
+			if (Check.bCancel || FPlatformTime::Seconds() - StartTime > ProcessTimeoutSeconds)
+			{
+				// waits for the process to be gone, so nothing it was writing changes afterwards
+				FPlatformProcess::TerminateProc(Process, true);
+				FPlatformProcess::WaitForProc(Process);
+				OutOutput += Check.bCancel ? TEXT("(cancelled)") : TEXT("(timed out)");
+				bTerminated = true;
+				break;
+			}
+			FPlatformProcess::Sleep(0.05f);
+		}
+		OutOutput += FPlatformProcess::ReadPipe(ReadPipe);
+
+		int32 ReturnCode = -1;
+		bSucceeded = !bTerminated && FPlatformProcess::GetProcReturnCode(Process, &ReturnCode) && ReturnCode == 0;
+		FPlatformProcess::CloseProc(Process);
+	}
+	else
+	{
+		OutOutput = FString::Printf(TEXT("could not start %s"), *ExePath);
+	}
+
+	FPlatformProcess::ClosePipe(ReadPipe, WritePipe);
+	return bSucceeded;
+}
+
+bool FWakaTimeCliUpdater::RunPowershell(const FString& Command, const FCheck& Check, FString& OutOutput)
+{
+	// without the progress bar, Invoke-WebRequest downloads many times faster
+	return RunProcess(GPowershellPath, FString::Printf(TEXT("-NoProfile -NonInteractive -Command \"$ProgressPreference = 'SilentlyContinue'; %s\""),
+	                                                   *Command), Check, OutOutput);
+}
+
+std::string FWakaTimeCliUpdater::GetBinaryVersion(const FString& ExePath, const FCheck& Check)
+{
+	FString Output;
+	if (!RunProcess(ExePath, TEXT("--version"), Check, Output))
+	{
+		return "";
+	}
+	return FWakaTimeCliManifest::ParseVersionOutput(TCHAR_TO_UTF8(*Output));
+}
+
+bool FWakaTimeCliUpdater::SwapBinary(const FString& NewExePath, const FString& ExePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FString OldExePath = ExePath + TEXT(".old");
+
+	// fails while a cli started before the previous swap still runs; the rename below fails then too, and nothing changes
+	PlatformFile.DeleteFile(*OldExePath);
+
+	// a running binary can be renamed, but not overwritten
+	bool bHadBinary = PlatformFile.FileExists(*ExePath);
+	if (bHadBinary && !PlatformFile.MoveFile(*OldExePath, *ExePath))
+	{
+		return false;
+	}
+
+	if (!PlatformFile.MoveFile(*ExePath, *NewExePath))
+	{
+		if (bHadBinary)
+		{
+			PlatformFile.MoveFile(*ExePath, *OldExePath);
+		}
+		return false;
+	}
+
+	return true;
+}
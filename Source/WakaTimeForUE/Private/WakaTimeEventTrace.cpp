@@ -0,0 +1,216 @@
+#include "WakaTimeEventTrace.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+// The buffer is written out once it grows past this, so recording costs no file access per event
+static constexpr int32 GTraceFlushBytes = 16 * 1024;
+
+template <typename T>
+static void AppendValue(TArray<uint8>& Buffer, const T& Value)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+}
+
+template <typename T>
+static bool ReadValue(const TArray<uint8>& Buffer, int32& Offset, T& OutValue)
+{
+	if (Offset + static_cast<int32>(sizeof(T)) > Buffer.Num())
+	{
+		return false;
+	}
+	FMemory::Memcpy(&OutValue, Buffer.GetData() + Offset, sizeof(T));
+	Offset += sizeof(T);
+	return true;
+}
+
+FWakaTimeEventTrace::~FWakaTimeEventTrace()
+{
+	StopRecording();
+	StopReplay();
+}
+
+bool FWakaTimeEventTrace::StartRecording(const FString& Path)
+{
+	StopRecording();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+	FileHandle = PlatformFile.OpenWrite(*Path);
+	if (!FileHandle)
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("Could not create trace file %s"), *Path);
+		return false;
+	}
+
+	WriteBuffer.Reset();
+	AppendValue(WriteBuffer, Magic);
+	AppendValue(WriteBuffer, Version);
+	RecordingStartTime = FPlatformTime::Seconds();
+	NumRecorded = 0;
+
+	UE_LOG(LogWakaTime, Log, TEXT("Recording editor events into %s"), *Path);
+	return true;
+}
+
+void FWakaTimeEventTrace::StopRecording()
+{
+	if (!FileHandle)
+	{
+		return;
+	}
+
+	FlushBuffer();
+	delete FileHandle;
+	FileHandle = nullptr;
+
+	UE_LOG(LogWakaTime, Log, TEXT("Stopped recording, %u events in %.0f s"), NumRecorded,
+	       FPlatformTime::Seconds() - RecordingStartTime);
+}
+
+void FWakaTimeEventTrace::Record(EWakaTimeEvent Event, const FString& Argument)
+{
+	if (!FileHandle)
+	{
+		return;
+	}
+
+	FTCHARToUTF8 Utf8Argument(*Argument);
+	uint16 Length = static_cast<uint16>(FMath::Min(Utf8Argument.Length(), static_cast<int32>(MAX_uint16)));
+
+	AppendValue(WriteBuffer, static_cast<uint8>(Event));
+	AppendValue(WriteBuffer, FPlatformTime::Seconds() - RecordingStartTime);
+	AppendValue(WriteBuffer, Length);
+	WriteBuffer.Append(reinterpret_cast<const uint8*>(Utf8Argument.Get()), Length);
+	NumRecorded++;
+
+	if (WriteBuffer.Num() >= GTraceFlushBytes)
+	{
+		FlushBuffer();
+	}
+}
+
+void FWakaTimeEventTrace::FlushBuffer()
+{
+	if (FileHandle && WriteBuffer.Num() > 0)
+	{
+		FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+		FileHandle->Flush();
+	}
+	WriteBuffer.Reset();
+}
+
+bool FWakaTimeEventTrace::StartReplay(const FString& Path, double Speed,
+                                      TFunction<void(EWakaTimeEvent, const FString&, double)> InOnEvent,
+                                      TFunction<void()> InOnFinished)
+{
+	StopReplay();
+
+	TArray<uint8> Buffer;
+	if (!FFileHelper::LoadFileToArray(Buffer, *Path))
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("Could not read trace file %s"), *Path);
+		return false;
+	}
+
+	int32 Offset = 0;
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	if (!ReadValue(Buffer, Offset, FileMagic) || !ReadValue(Buffer, Offset, FileVersion) || FileMagic != Magic ||
+		FileVersion != Version)
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("%s is not a trace file of this plugin version"), *Path);
+		return false;
+	}
+
+	while (Offset < Buffer.Num())
+	{
+		uint8 Event = 0;
+		double Time = 0.0;
+		uint16 Length = 0;
+		if (!ReadValue(Buffer, Offset, Event) || !ReadValue(Buffer, Offset, Time) || !ReadValue(Buffer, Offset, Length) ||
+			Offset + Length > Buffer.Num() || Event >= static_cast<uint8>(EWakaTimeEvent::Count))
+		{
+			// a trace of a crashed session ends with a partial event
+			UE_LOG(LogWakaTime, Warning, TEXT("Trace is truncated after %d events"), ReplayRecords.Num());
+			break;
+		}
+
+		FUTF8ToTCHAR Argument(reinterpret_cast<const ANSICHAR*>(Buffer.GetData() + Offset), Length);
+		Offset += Length;
+
+		ReplayRecords.Add({static_cast<EWakaTimeEvent>(Event), Time, FString(Argument.Length(), Argument.Get())});
+	}
+
+	if (ReplayRecords.Num() == 0)
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("Trace %s contains no events"), *Path);
+		return false;
+	}
+
+	ReplayIndex = 0;
+	ReplaySpeed = Speed;
+	ReplayStartTime = FPlatformTime::Seconds();
+	ReplayClockOrigin = FWakaTimeHeartbeatScheduler::Now() - ReplayRecords.Last().Time;
+	OnEvent = MoveTemp(InOnEvent);
+	OnFinished = MoveTemp(InOnFinished);
+
+	UE_LOG(LogWakaTime, Log, TEXT("Replaying %d events covering %.0f s at %gx"), ReplayRecords.Num(),
+	       ReplayRecords.Last().Time, ReplaySpeed);
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeEventTrace::TickReplay));
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeEventTrace::TickReplay));
+#endif
+	return true;
+}
+
+void FWakaTimeEventTrace::StopReplay()
+{
+	if (ReplayRecords.Num() == 0)
+	{
+		return;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	UE_LOG(LogWakaTime, Log, TEXT("Replay stopped after %d of %d events, took %.1f s"), ReplayIndex,
+	       ReplayRecords.Num(), FPlatformTime::Seconds() - ReplayStartTime);
+
+	ReplayRecords.Empty();
+	ReplayIndex = 0;
+
+	if (OnFinished)
+	{
+		OnFinished();
+	}
+}
+
+bool FWakaTimeEventTrace::TickReplay(float DeltaTime)
+{
+	double TraceTime = ReplaySpeed > 0.0 ? (FPlatformTime::Seconds() - ReplayStartTime) * ReplaySpeed : TNumericLimits<double>::Max();
+	int32 Budget = ReplaySpeed > 0.0 ? ReplayRecords.Num() : MaxEventsPerFrameUnthrottled;
+
+	while (ReplayIndex < ReplayRecords.Num() && ReplayRecords[ReplayIndex].Time <= TraceTime && Budget-- > 0)
+	{
+		const FTraceRecord& Record = ReplayRecords[ReplayIndex++];
+		OnEvent(Record.Event, Record.Argument, ReplayClockOrigin + Record.Time);
+	}
+
+	if (ReplayIndex >= ReplayRecords.Num())
+	{
+		StopReplay();
+		return false;
+	}
+
+	return true;
+}
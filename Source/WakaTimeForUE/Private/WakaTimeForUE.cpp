@@ -6,14 +6,28 @@
 #include "GeneralProjectSettings.h"
 #include "LevelEditor.h"
 #include "WakaTimeHelpers.h"
+#include "WakaTimeProcessSupervisor.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "WakaTimeRelayClient.h"
+#include "WakaTimeHeartbeatSpool.h"
+#include "WakaTimeCommand.h"
+#include "WakaTimeConfig.h"
+#include "WakaTimeTodayStatus.h"
+#include "WakaTimeCliUpdater.h"
 #include "Styling/SlateStyleRegistry.h"
 #include <Editor/MainFrame/Public/Interfaces/IMainFrameModule.h>
 #include <activation.h>
-#include <fstream>
 
 #include "BlueprintEditorModule.h"
 #include "Interfaces/IPluginManager.h"
 #include "UObject/ObjectSaveContext.h"
+#include "Editor/TransBuffer.h"
+#include "Engine/LevelStreaming.h"
+#if ENGINE_MAJOR_VERSION >= 5 // World Partition and level instances do not exist before UE5
+#include "WorldPartition/WorldPartitionLevelStreamingDynamic.h"
+#include "LevelInstance/LevelInstanceLevelStreaming.h"
+#include "LevelInstance/LevelInstanceEditorLevelStreaming.h"
+#endif
 
 using namespace std;
 
@@ -22,6 +36,10 @@ using namespace std;
 // Global variables
 string GAPIKey("");
 string GAPIUrl("");
+string GRelayUrl("");
+string GRelaySecret("");
+double GTodayIntervalSeconds = 300.0;
+double GCliUpdateIntervalSeconds = 86400.0;
 string GBaseCommand("");
 string GUserProfile;
 string GProjectPath;
@@ -39,25 +57,59 @@ FDelegateHandle GPostPieStartedHandle;
 FDelegateHandle GPrePieEndedHandle;
 FDelegateHandle OnBlueprintPreCompileHandle;
 FDelegateHandle OnEditorInitializedHandle;
+FDelegateHandle ObjectPropertyChangedHandle;
+FDelegateHandle TransactionStateChangedHandle;
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 4 // RedTheKitsune(OnAssetClosedInEditor is not available in <UE5.4, so blueprint name tracking will not work properly)
 FDelegateHandle OnAssetOpenedInEditorHandle;
 FDelegateHandle OnAssetClosedInEditorHandle;
 #endif
 
 // UI Elements
-TSharedRef<SEditableTextBox> GAPIKeyBlock = SNew(SEditableTextBox)
-.Text(FText::FromString(FString(UTF8_TO_TCHAR(GAPIKey.c_str())))).MinDesiredWidth(500);
-TSharedRef<SEditableTextBox> GAPIUrlBlock = SNew(SEditableTextBox)
-.Text(FText::FromString(FString(UTF8_TO_TCHAR(GAPIUrl.c_str())))).MinDesiredWidth(500);
-TSharedRef<SWindow> SettingsWindow = SNew(SWindow);
 TSharedPtr<FSlateStyleSet> StyleSetInstance = nullptr;
 
+// Hard limit of the time the editor close may spend on sending the last heartbeats
+constexpr double GShutdownFlushSeconds = 2.0;
+
+// Heartbeats sent by a single cli call; the cli sends them to the api in bulk requests of 25
+constexpr size_t GMaxHeartbeatsPerCall = 50;
+
+// A long play session hands its heartbeats over in batches at this rate, so a crash mid-session loses little
+constexpr float GPieBatchSeconds = 600.0f;
+
+// Level additions carry their source in front of the package name, e.g. "WorldPartition /Game/Map/Cell",
+// so a replayed trace is filtered the same way as the live editor
+static const TCHAR* const GLevelSourceNames[] = {TEXT("User"), TEXT("Streaming"), TEXT("WorldPartition"), TEXT("PlayInEditor")};
+static_assert(UE_ARRAY_COUNT(GLevelSourceNames) == static_cast<int32>(EWakaTimeLevelSource::Count),
+              "Every level source needs a name");
+
+static EWakaTimeLevelSource ParseLevelSource(const FString& Argument)
+{
+	FString SourceName;
+	FString PackageName;
+	if (Argument.Split(TEXT(" "), &SourceName, &PackageName))
+	{
+		for (int32 Index = 0; Index < static_cast<int32>(EWakaTimeLevelSource::Count); Index++)
+		{
+			if (SourceName == GLevelSourceNames[Index])
+			{
+				return static_cast<EWakaTimeLevelSource>(Index);
+			}
+		}
+	}
+
+	// traces recorded before the source was added only contain the levels the user added
+	return EWakaTimeLevelSource::User;
+}
+
 
 DEFINE_LOG_CATEGORY(LogWakaTime);
 
 // Module methods
 void FWakaTimeForUEModule::StartupModule()
 {
+	double StartupStartTime = FPlatformTime::Seconds();
+	uint64 StartupStartMemory = FPlatformMemory::GetStats().UsedPhysical;
+
 	AssignGlobalVariables();
 
 	FString WakatimeCliFilePath = FString(GUserProfile.c_str()) + TEXT("\\.wakatime\\") + FString(GWakaCliVersion.c_str());
@@ -72,8 +124,7 @@ void FWakaTimeForUEModule::StartupModule()
 	{
 		// neither way was found; download and install the new version
 		UE_LOG(LogWakaTime, Log, TEXT("Did not find wakatime"));
-		GBaseCommand = "/c start \"\" /b \"" + string(GUserProfile) + "\\.wakatime\\" +
-			GWakaCliVersion + "\"";
+		GBaseCommand = (string(GUserProfile) + "\\.wakatime\\" + GWakaCliVersion);
 		string FolderPath = string(GUserProfile) + "\\.wakatime";
 		if (!FWakaTimeHelpers::PathExists(FolderPath))
 		{
@@ -84,6 +135,32 @@ void FWakaTimeForUEModule::StartupModule()
 	// TheAshenWolf(Wakatime-cli.exe is not in the path by default, which is why we have to use the user path)
 
 
+	ProcessSupervisor.Initialize([](const std::vector<FWakaTimeHeartbeat>& Heartbeats)
+	{
+		// sent with the spooled heartbeats on the next launch
+		FWakaTimeHeartbeatSpool::Append(GetHeartbeatSpoolPath(), Heartbeats);
+	});
+	HeartbeatScheduler.Initialize([this](const FWakaTimeHeartbeat& Heartbeat) { LaunchHeartbeat(Heartbeat); },
+	                              [](const FWakaTimeHeartbeat& Heartbeat)
+	                              {
+		                              // sent with the spooled heartbeats on the next launch
+		                              FWakaTimeHeartbeatSpool::Append(GetHeartbeatSpoolPath(), {Heartbeat});
+	                              },
+	                              [this]() { return !RelayClient.IsConnected() && ProcessSupervisor.IsSaturated(); });
+	ActivityTracker.Initialize([this](const FString& FilePath, double Time)
+	{
+		HandleEditorEvent(EWakaTimeEvent::PropertiesEdited, FilePath, Time);
+	});
+	SubmissionQueue.Initialize([this](const FWakaTimeActivity& Activity, double Time)
+	{
+		// an unset name would be sent as the text "None"
+		SendHeartbeat(Activity.bIsWrite, Activity.Category.IsNone() ? "coding" : TCHAR_TO_UTF8(*Activity.Category.ToString()),
+		              Activity.EntityType.IsNone() ? "file" : TCHAR_TO_UTF8(*Activity.EntityType.ToString()),
+		              Activity.Entity.ToString(),
+		              Activity.Language.IsNone() ? "Unreal Editor" : TCHAR_TO_UTF8(*Activity.Language.ToString()), Time,
+		              Activity.Priority == EWakaTimeActivityPriority::High);
+	});
+
 	if (!StyleSetInstance.IsValid())
 	{
 		StyleSetInstance = CreateToolbarIcon();
@@ -91,8 +168,24 @@ void FWakaTimeForUEModule::StartupModule()
 	}
 
 	string ConfigFileDir = string(GUserProfile) + "\\.wakatime.cfg";
+	// the built-in defaults, for when there is no config to read them from yet
+	LoadEventPolicies(FWakaTimeConfig());
 	HandleStartupApiCheck(ConfigFileDir);
 
+	if (!GRelayUrl.empty())
+	{
+		RelayClient.Initialize(GRelayUrl, GRelaySecret, GAPIKey, "unreal-wakatime/" + GPluginVersion);
+	}
+
+	SendSpooledHeartbeats();
+
+	ApplyTodaySettings();
+
+	// the first check runs on the updater tick, never here; checks are at least an hour apart
+	CliUpdater.Initialize(UTF8_TO_TCHAR((GUserProfile + "\\.wakatime").c_str()), UTF8_TO_TCHAR(GWakaCliVersion.c_str()),
+	                      UTF8_TO_TCHAR(GWakatimeArchitecture.c_str()),
+	                      GCliUpdateIntervalSeconds > 0.0 ? FMath::Max(GCliUpdateIntervalSeconds, 3600.0) : 0.0);
+
 	// Add Listeners
 	NewActorsDroppedHandle = FEditorDelegates::OnNewActorsDropped.AddRaw(
 		this, &FWakaTimeForUEModule::OnNewActorDropped);
@@ -111,6 +204,16 @@ void FWakaTimeForUEModule::StartupModule()
 	GPrePieEndedHandle = FEditorDelegates::PrePIEEnded.AddRaw(this, &FWakaTimeForUEModule::OnPrePieEnded);
 	
 	OnEditorInitializedHandle = FEditorDelegates::OnEditorInitialized.AddRaw(this, &FWakaTimeForUEModule::OnEditorInitialized);
+	ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(
+		this, &FWakaTimeForUEModule::OnObjectPropertyChanged);
+
+	RegisterConsoleCommands();
+
+	FString TracePath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("WakaTimeTrace="), TracePath))
+	{
+		EventTrace.StartRecording(TracePath);
+	}
 
 	FWakaCommands::Register();
 
@@ -133,6 +236,11 @@ void FWakaTimeForUEModule::StartupModule()
 	                                        FToolBarExtensionDelegate::CreateRaw(
 		                                        this, &FWakaTimeForUEModule::AddToolbarButton));
 	LevelEditorModule.GetToolBarExtensibilityManager()->AddExtender(NewToolbarExtender);
+
+	// the memory difference is process wide, so other modules starting on other threads end up in it too
+	UE_LOG(LogWakaTime, Log, TEXT("Started in %.1f ms, resident memory %+lld KB"),
+	       (FPlatformTime::Seconds() - StartupStartTime) * 1000.0,
+	       (static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(StartupStartMemory)) / 1024);
 }
 
 void FWakaTimeForUEModule::ShutdownModule()
@@ -149,11 +257,17 @@ void FWakaTimeForUEModule::ShutdownModule()
 #endif
 	FEditorDelegates::PostPIEStarted.Remove(GPostPieStartedHandle);
 	FEditorDelegates::PrePIEEnded.Remove(GPrePieEndedHandle);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
 	
 	if (GEditor)
 	{
 		GEditor->OnBlueprintPreCompile().Remove(OnBlueprintPreCompileHandle);
 
+		if (UTransBuffer* TransBuffer = Cast<UTransBuffer>(GEditor->Trans))
+		{
+			TransBuffer->OnTransactionStateChanged().Remove(TransactionStateChangedHandle);
+		}
+
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 4 // RedTheKitsune(OnAssetClosedInEditor is not available in <UE5.4, so blueprint name tracking will not work properly)
 		if (UAssetEditorSubsystem* AssetEditorSubsystem = GEditor->GetEditorSubsystem<UAssetEditorSubsystem>())
 		{
@@ -162,6 +276,123 @@ void FWakaTimeForUEModule::ShutdownModule()
 		}
 #endif
 	}
+
+	for (IConsoleObject* Command : ConsoleCommands)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(Command);
+	}
+	ConsoleCommands.Empty();
+
+	if (SettingsWindow.IsValid())
+	{
+		SettingsWindow->SetOnWindowClosed(FOnWindowClosed());
+		if (FSlateApplication::IsInitialized())
+		{
+			SettingsWindow->RequestDestroyWindow();
+		}
+		OnSettingsWindowClosed(SettingsWindow.ToSharedRef());
+	}
+
+	EventTrace.StopReplay();
+	TodayStatus.Shutdown();
+	CliUpdater.Shutdown();
+	SubmissionQueue.Shutdown();
+	ActivityTracker.Shutdown(); // still reports the last interval, so it goes before the trace and the scheduler
+	EventTrace.StopRecording();
+
+	StopPieSession(); // closing the editor during a play session skips PrePIEEnded
+	FlushHeartbeatsOnShutdown();
+	HeartbeatScheduler.Shutdown();
+
+	// the relay gets no time to catch up; what it did not receive is sent by the cli on the next launch
+	std::vector<FWakaTimeHeartbeat> Unrelayed = RelayClient.Shutdown();
+	if (!Unrelayed.empty())
+	{
+		FWakaTimeHeartbeatSpool::Append(GetHeartbeatSpoolPath(), Unrelayed);
+	}
+	ProcessSupervisor.Shutdown();
+}
+
+void FWakaTimeForUEModule::FlushHeartbeatsOnShutdown()
+{
+	double StartTime = FPlatformTime::Seconds();
+
+	// whatever the scheduler held back and whatever was waiting for a free process slot
+	std::vector<FWakaTimeHeartbeat> Remaining = HeartbeatScheduler.TakePending();
+	for (const FWakaTimeProcessRequest& Request : ProcessSupervisor.TakeQueued())
+	{
+		Remaining.insert(Remaining.end(), Request.Heartbeats.begin(), Request.Heartbeats.end());
+	}
+
+	if (Remaining.empty())
+	{
+		return;
+	}
+
+	int32 NumRelayed = 0;
+	if (RelayClient.IsConnected())
+	{
+		// whatever the relay client cannot write out without waiting goes into the spool when it shuts down
+		for (const FWakaTimeHeartbeat& Heartbeat : Remaining)
+		{
+			NumRelayed += RelayClient.Send(Heartbeat, Heartbeat.Project) ? 1 : 0;
+		}
+		if (NumRelayed == static_cast<int32>(Remaining.size()))
+		{
+			UE_LOG(LogWakaTime, Log, TEXT("Shutdown flush: %d heartbeats handed to the relay in %.1f ms"), NumRelayed,
+			       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+			return;
+		}
+		Remaining.erase(Remaining.begin(), Remaining.begin() + NumRelayed);
+	}
+
+	size_t BatchSize = FMath::Min(Remaining.size(), GMaxHeartbeatsPerCall);
+	std::vector<FWakaTimeHeartbeat> Batch(Remaining.begin(), Remaining.begin() + BatchSize);
+	std::vector<FWakaTimeHeartbeat> Persisted(Remaining.begin() + BatchSize, Remaining.end());
+
+	uint32 ExitCode = 0;
+	double TimeLeft = GShutdownFlushSeconds - (FPlatformTime::Seconds() - StartTime);
+	bool bSent = ProcessSupervisor.LaunchAndWait(BuildHeartbeatRequest(Batch), TimeLeft, ExitCode) &&
+		FWakaTimeProcessSupervisor::IsHeartbeatExitSafe(ExitCode);
+	if (!bSent)
+	{
+		// sent again on the next launch; a heartbeat the cli got out before it was terminated is deduplicated by the api
+		Persisted.insert(Persisted.begin(), Batch.begin(), Batch.end());
+		Batch.clear();
+	}
+
+	if (!Persisted.empty())
+	{
+		FWakaTimeHeartbeatSpool::Append(GetHeartbeatSpoolPath(), Persisted);
+	}
+
+	UE_LOG(LogWakaTime, Log,
+	       TEXT("Shutdown flush: %d heartbeats relayed, %d sent in one cli call, %d kept for the next launch; took %.1f ms of the editor close"),
+	       NumRelayed, static_cast<int32>(Batch.size()), static_cast<int32>(Persisted.size()),
+	       (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void FWakaTimeForUEModule::SendSpooledHeartbeats()
+{
+	std::vector<FWakaTimeHeartbeat> Spooled = FWakaTimeHeartbeatSpool::Take(GetHeartbeatSpoolPath());
+	if (Spooled.empty())
+	{
+		return;
+	}
+
+	UE_LOG(LogWakaTime, Log, TEXT("Sending %d heartbeats left over from the last session"), static_cast<int32>(Spooled.size()));
+
+	for (size_t First = 0; First < Spooled.size(); First += GMaxHeartbeatsPerCall)
+	{
+		size_t Last = FMath::Min(First + GMaxHeartbeatsPerCall, Spooled.size());
+		ProcessSupervisor.Launch(BuildHeartbeatRequest(std::vector<FWakaTimeHeartbeat>(Spooled.begin() + First,
+		                                                                               Spooled.begin() + Last)));
+	}
+}
+
+FString FWakaTimeForUEModule::GetHeartbeatSpoolPath()
+{
+	return FString(UTF8_TO_TCHAR(GUserProfile.c_str())) + TEXT("\\.wakatime\\unreal-heartbeats.jsonl");
 }
 
 void FWakaCommands::RegisterCommands()
@@ -225,38 +456,28 @@ void FWakaTimeForUEModule::HandleStartupApiCheck(string ConfigFilePath)
 
 void FWakaTimeForUEModule::ReadConfig(string ConfigFilePath, bool& bFoundApiKey, bool& bFoundApiUrl)
 {
-	string Line;
-	
-	fstream ConfigFile(ConfigFilePath);
-
-	while (getline(ConfigFile, Line))
-	{
-		if (Line.find("api_key") != string::npos)
-		{
-			GAPIKey = Line.substr(Line.find(" = ") + 3); // Pozitrone(Extract only the api key from the line);
-			GAPIKeyBlock.Get().SetText(FText::FromString(FString(UTF8_TO_TCHAR(GAPIKey.c_str()))));
-			bFoundApiKey = true;
-		}
-
-		if (Line.find("api_url") != string::npos)
-		{
-			GAPIUrl = Line.substr(Line.find(" = ") + 3); // Pozitrone(Extract only the url key from the line);
-			GAPIUrlBlock.Get().SetText(FText::FromString(FString(UTF8_TO_TCHAR(GAPIUrl.c_str()))));
-			bFoundApiUrl = true;
-		}
-	}
-
-	if(!bFoundApiKey)
-	{
-		GAPIKeyBlock.Get().SetText(FText::GetEmpty());
-	}
-
-	if(!bFoundApiUrl)
-	{
-		GAPIUrlBlock.Get().SetText(FText::GetEmpty());
-	}
+	FWakaTimeConfig Config;
+	Config.Load(ConfigFilePath);
+
+	bFoundApiKey = Config.Has("settings", "api_key");
+	bFoundApiUrl = Config.Has("settings", "api_url");
+	GAPIKey = Config.Get("settings", "api_key");
+	GAPIUrl = Config.Get("settings", "api_url");
+	GRelayUrl = Config.Get("settings", "relay_url");
+	GRelaySecret = Config.Get("settings", "relay_secret");
+
+	// settings only this plugin reads live in their own section, other IDEs and the cli ignore it
+	GTodayIntervalSeconds = Config.GetDouble("unreal", "today_interval", 300.0);
+	GCliUpdateIntervalSeconds = Config.GetDouble("unreal", "cli_update_interval", 86400.0);
+	LoadEventPolicies(Config);
+}
 
-	ConfigFile.close();
+void FWakaTimeForUEModule::ApplyTodaySettings()
+{
+	// a minute is the resolution of the summary anyway
+	TodayStatus.Reconfigure(UTF8_TO_TCHAR(GBaseCommand.c_str()),
+	                        UTF8_TO_TCHAR(FWakaTimeCommandBuilder::BuildToday(GetCliSettings()).ToCommandLine().c_str()),
+	                        GTodayIntervalSeconds > 0.0 ? FMath::Max(GTodayIntervalSeconds, 60.0) : 0.0);
 }
 
 void FWakaTimeForUEModule::DownloadWakatimeCli(string CliPath)
@@ -311,6 +532,116 @@ string FWakaTimeForUEModule::GetProjectName()
 }
 
 
+void FWakaTimeForUEModule::RegisterConsoleCommands()
+{
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("WakaTime.Trace.Record"),
+		TEXT("Records every editor event the plugin receives. Usage: WakaTime.Trace.Record [Path]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([this](const TArray<FString>& Args)
+		{
+			FString Path = Args.Num() > 0
+				               ? Args[0]
+				               : FPaths::ProjectSavedDir() / TEXT("WakaTime") / (TEXT("Trace-") + FDateTime::Now().ToString() + TEXT(".wktrace"));
+			EventTrace.StartRecording(Path);
+		})));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("WakaTime.Trace.Stop"),
+		TEXT("Stops recording or replaying a trace"),
+		FConsoleCommandDelegate::CreateLambda([this]()
+		{
+			EventTrace.StopRecording();
+			EventTrace.StopReplay();
+		})));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("WakaTime.Trace.Replay"),
+		TEXT("Feeds a recorded trace through the heartbeat pipeline; real heartbeats are sent, so point relay_url or api_url at a test server. Usage: WakaTime.Trace.Replay Path [Speed, 0 = as fast as possible]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([this](const TArray<FString>& Args)
+		{
+			if (Args.Num() == 0)
+			{
+				UE_LOG(LogWakaTime, Warning, TEXT("Usage: WakaTime.Trace.Replay Path [Speed]"));
+				return;
+			}
+
+			double Speed = Args.Num() > 1 ? FCString::Atod(*Args[1]) : 1.0;
+			EventTrace.StartReplay(Args[0], Speed,
+			                       [this](EWakaTimeEvent Event, const FString& Argument, double Time)
+			                       {
+				                       HandleEditorEvent(Event, Argument, Time);
+			                       },
+			                       [this]() { LogStats(); });
+		})));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("WakaTime.Bench.PropertyMarks"),
+		TEXT("Measures the cost of the property change hook. Usage: WakaTime.Bench.PropertyMarks [Count]"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([this](const TArray<FString>& Args)
+		{
+			int32 Count = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000;
+
+			// a few loaded packages, so the benchmark covers both the repeated and the table lookup path
+			TArray<UObject*> Objects;
+			for (TObjectIterator<UPackage> It; It && Objects.Num() < 16; ++It)
+			{
+				if (!It->HasAnyPackageFlags(PKG_PlayInEditor) && *It != GetTransientPackage())
+				{
+					Objects.Add(*It);
+				}
+			}
+			if (Objects.Num() == 0)
+			{
+				return;
+			}
+
+			// a separate tracker, so the benchmark does not end up in heartbeats
+			FWakaTimeActivityTracker BenchTracker;
+
+			double RepeatedStart = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				BenchTracker.MarkObject(Objects[0]);
+			}
+			double RepeatedSeconds = FPlatformTime::Seconds() - RepeatedStart;
+
+			double MixedStart = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				BenchTracker.MarkObject(Objects[Index % Objects.Num()]);
+			}
+			double MixedSeconds = FPlatformTime::Seconds() - MixedStart;
+
+			UE_LOG(LogWakaTime, Log,
+			       TEXT("Property marks: %.1f ns per mark while dragging, %.1f ns per mark across %d packages; 1000 changes per second cost %.4f%% of the frame time"),
+			       RepeatedSeconds * 1e9 / Count, MixedSeconds * 1e9 / Count, Objects.Num(),
+			       MixedSeconds / Count * 1000.0 * 100.0);
+		})));
+
+	ConsoleCommands.Add(IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("WakaTime.Stats"),
+		TEXT("Writes the counters of the heartbeat pipeline into the log"),
+		FConsoleCommandDelegate::CreateRaw(this, &FWakaTimeForUEModule::LogStats)));
+}
+
+void FWakaTimeForUEModule::LogStats()
+{
+	UE_LOG(LogWakaTime, Log, TEXT("Play sessions: %u synthetic heartbeats"), NumPieSessionHeartbeats);
+	UE_LOG(LogWakaTime, Log, TEXT("Event policies: %u events filtered by sample rate or minimum interval"),
+	       NumEventsFilteredByPolicy);
+	UE_LOG(LogWakaTime, Log, TEXT("Levels added: %llu by the user, %llu streamed, %llu World Partition cells, %llu by play sessions"),
+	       NumLevelAdditions[static_cast<int32>(EWakaTimeLevelSource::User)],
+	       NumLevelAdditions[static_cast<int32>(EWakaTimeLevelSource::Streaming)],
+	       NumLevelAdditions[static_cast<int32>(EWakaTimeLevelSource::WorldPartition)],
+	       NumLevelAdditions[static_cast<int32>(EWakaTimeLevelSource::PlayInEditor)]);
+	ActivityTracker.LogStats();
+	SubmissionQueue.LogStats();
+	TodayStatus.LogStats();
+	CliUpdater.LogStats();
+	HeartbeatScheduler.LogStats();
+	ProcessSupervisor.LogStats();
+}
+
 // UI methods
 TSharedRef<FSlateStyleSet> FWakaTimeForUEModule::CreateToolbarIcon()
 {
@@ -332,6 +663,17 @@ void FWakaTimeForUEModule::AddToolbarButton(FToolBarBuilder& Builder)
 	Builder.AddToolBarButton(FWakaCommands::Get().WakaTimeSettingsCommand, NAME_None, FText::FromString("WakaTime"),
 	                         FText::FromString("WakaTime plugin settings"),
 	                         Icon, NAME_None);
+
+	// only reads the cached value; every toolbar showing it shares the one refresh
+	Builder.AddWidget(
+		SNew(SBox)
+		.VAlign(VAlign_Center)
+		.Padding(FMargin(4.0f, 0.0f))
+		[
+			SNew(STextBlock)
+			.Text(TAttribute<FText>::CreateLambda([this]() { return TodayStatus.GetText(); }))
+			.ToolTipText(TAttribute<FText>::CreateLambda([this]() { return TodayStatus.GetToolTip(); }))
+		]);
 }
 
 void FWakaTimeForUEModule::OpenSettingsWindowFromUI()
@@ -339,12 +681,22 @@ void FWakaTimeForUEModule::OpenSettingsWindowFromUI()
 	bool bFoundApiKey = false;
 	bool bFoundApiUrl = false;
 	ReadConfig(string(GUserProfile) + "\\.wakatime.cfg", bFoundApiKey, bFoundApiUrl);
+	ApplyTodaySettings();
 
 	OpenSettingsWindow();
 }
 
 void FWakaTimeForUEModule::OpenSettingsWindow()
 {
+	if (SettingsWindow.IsValid())
+	{
+		SettingsWindow->BringToFront();
+		return;
+	}
+
+	double CreateStartTime = FPlatformTime::Seconds();
+
+	// the widgets only live while the window is open; the config state they edit stays in the globals
 	SettingsWindow = SNew(SWindow)
 		.Title(FText::FromString(TEXT("WakaTime Settings")))
 		.ClientSize(FVector2D(800, 400))
@@ -368,7 +720,8 @@ void FWakaTimeForUEModule::OpenSettingsWindow()
 			  .HAlign(HAlign_Center)
 			  .VAlign(VAlign_Center)
 			[
-				GAPIKeyBlock
+				SAssignNew(ApiKeyTextBox, SEditableTextBox)
+				.Text(FText::FromString(FString(UTF8_TO_TCHAR(GAPIKey.c_str())))).MinDesiredWidth(500)
 			]
 			+ SVerticalBox::Slot()
 			.HAlign(HAlign_Left)
@@ -381,7 +734,8 @@ void FWakaTimeForUEModule::OpenSettingsWindow()
 				.HAlign(HAlign_Center)
 				.VAlign(VAlign_Center)
 			[
-				GAPIUrlBlock
+				SAssignNew(ApiUrlTextBox, SEditableTextBox)
+				.Text(FText::FromString(FString(UTF8_TO_TCHAR(GAPIUrl.c_str())))).MinDesiredWidth(500)
 			]
 		]
 		+ SVerticalBox::Slot()
@@ -396,200 +750,432 @@ void FWakaTimeForUEModule::OpenSettingsWindow()
 			]
 		]
 	];
+	SettingsWindow->SetOnWindowClosed(FOnWindowClosed::CreateRaw(this, &FWakaTimeForUEModule::OnSettingsWindowClosed));
+
 	IMainFrameModule& MainFrameModule =
 		FModuleManager::LoadModuleChecked<IMainFrameModule>(TEXT
 			("MainFrame"));
 	if (MainFrameModule.GetParentWindow().IsValid())
 	{
 		FSlateApplication::Get().AddWindowAsNativeChild
-		(SettingsWindow, MainFrameModule.GetParentWindow()
-		                                .ToSharedRef());
+		(SettingsWindow.ToSharedRef(), MainFrameModule.GetParentWindow()
+		                                              .ToSharedRef());
 	}
 	else
 	{
-		FSlateApplication::Get().AddWindow(SettingsWindow);
+		FSlateApplication::Get().AddWindow(SettingsWindow.ToSharedRef());
 	}
+
+	UE_LOG(LogWakaTime, Log, TEXT("Settings window created in %.1f ms"), (FPlatformTime::Seconds() - CreateStartTime) * 1000.0);
+}
+
+void FWakaTimeForUEModule::OnSettingsWindowClosed(const TSharedRef<SWindow>& Window)
+{
+	SettingsWindow.Reset();
+	ApiKeyTextBox.Reset();
+	ApiUrlTextBox.Reset();
 }
 
 FReply FWakaTimeForUEModule::SaveData()
 {
-	GAPIKey = TCHAR_TO_UTF8(*(GAPIKeyBlock.Get().GetText().ToString()));
-	GAPIUrl = TCHAR_TO_UTF8(*(GAPIUrlBlock.Get().GetText().ToString()));
+	GAPIKey = TCHAR_TO_UTF8(*ApiKeyTextBox->GetText().ToString());
+	GAPIUrl = TCHAR_TO_UTF8(*ApiUrlTextBox->GetText().ToString());
 
 	string ConfigFileDir = string(GUserProfile) + "/.wakatime.cfg";
-	fstream ConfigFile(ConfigFileDir);
 
-	if (!FWakaTimeHelpers::PathExists(ConfigFileDir) || ConfigFile.fail())
-	{
-		ConfigFile.open(ConfigFileDir, fstream::out);
-		// Pozitrone(Create the file if it does not exist) and write the data in it
-		ConfigFile << "[settings]" << '\n';
-		ConfigFile << "api_key = " << GAPIKey;
-		if(!GAPIUrl.empty())
-		{
-			ConfigFile << "api_url = " << GAPIUrl;
-		}
-		ConfigFile.close();
-
-		SettingsWindow.Get().RequestDestroyWindow();
-		return FReply::Handled();
-	}
+	// the file is shared with the cli and other IDEs, every other key and section has to survive
+	FWakaTimeConfig Config;
+	Config.Load(ConfigFileDir);
+	LoadEventPolicies(Config);
+	GTodayIntervalSeconds = Config.GetDouble("unreal", "today_interval", 300.0);
 
-	map<string, string> Data;
-	
-	string TempLine;
-	while (getline(ConfigFile, TempLine)) // RedKitsune(Turn entire ini file into TMap);
+	// an empty box must not wipe the key another IDE wrote; that key stays in use
+	if (GAPIKey.empty())
 	{
-		if(TempLine.find("[settings]") != string::npos) continue;
-
-		size_t Pos = TempLine.find(" = ");
-		string Key = TempLine.substr(0, Pos);
-		string Value = TempLine.substr(Pos + std::strlen(" = "));
-
-		Data.insert(std::make_pair(Key, Value));
+		GAPIKey = Config.Get("settings", "api_key");
 	}
-	ConfigFile.close();
+	bool bIsDirty = !GAPIKey.empty() && Config.Set("settings", "api_key", GAPIKey);
+	bIsDirty |= GAPIUrl.empty() ? Config.Remove("settings", "api_url") : Config.Set("settings", "api_url", GAPIUrl);
 
-	bool bIsDirty = false;
-	
-	UpdateIniEntry(bIsDirty, Data, "api_key", GAPIKey);
-	UpdateIniEntry(bIsDirty, Data, "api_url", GAPIUrl);
-	
-	if(bIsDirty)
+	if (bIsDirty)
 	{
 		UE_LOG(LogWakaTime, Log, TEXT("Saving settings"));
-		
-		ConfigFile.open(ConfigFileDir, fstream::out);
 
-		ConfigFile << "[settings]" << '\n';
-		
-		for(auto kvp : Data)
+		if (!Config.Save(ConfigFileDir))
 		{
-			ConfigFile << kvp.first << " = " << kvp.second << '\n';
+			UE_LOG(LogWakaTime, Error, TEXT("Could not write %s"), UTF8_TO_TCHAR(ConfigFileDir.c_str()));
 		}
-
-		ConfigFile.close();
 	}
 
-	SettingsWindow.Get().RequestDestroyWindow();
+	// picks up a changed api url or today_interval
+	ApplyTodaySettings();
+
+	SettingsWindow->RequestDestroyWindow();
 	return FReply::Handled();
 }
 
-void FWakaTimeForUEModule::UpdateIniEntry(bool& bIsDirty, map<string, string>& Data, string Key, string Value)
+// Lifecycle methods
+bool FWakaTimeForUEModule::SubmitActivity(const FWakaTimeActivity& Activity)
+{
+	return SubmissionQueue.Submit(Activity);
+}
+
+void FWakaTimeForUEModule::SendHeartbeat(bool bFileSave, string Activity, string EntityType, FString Entity, string Language,
+                                         double Time, bool bUrgent)
+{
+	FWakaTimeHeartbeat Heartbeat;
+	Heartbeat.Activity = Activity;
+	Heartbeat.EntityType = EntityType;
+	Heartbeat.Entity = TCHAR_TO_UTF8(*Entity.Replace(TEXT("/"), TEXT("\\")));
+	Heartbeat.Language = Language;
+	Heartbeat.Project = GetProjectName();
+	Heartbeat.bFileSave = bFileSave;
+	Heartbeat.Time = Time > 0.0 ? Time : FWakaTimeHeartbeatScheduler::Now();
+
+	// saves go into the write lane of the scheduler, which is released first and never shed
+	HeartbeatScheduler.Enqueue(Heartbeat, bUrgent);
+}
+
+void FWakaTimeForUEModule::LaunchHeartbeat(const FWakaTimeHeartbeat& Heartbeat)
+{
+	LaunchHeartbeats({Heartbeat});
+}
+
+void FWakaTimeForUEModule::LaunchHeartbeats(const std::vector<FWakaTimeHeartbeat>& Heartbeats)
 {
-	if(Value.empty())
+	// a studio relay batches the heartbeats of everyone, no process needed; if it is unreachable the cli sends directly
+	if (RelayClient.IsEnabled())
 	{
-		if(Data.contains(Key))
+		std::vector<FWakaTimeHeartbeat> NotRelayed;
+		for (const FWakaTimeHeartbeat& Heartbeat : Heartbeats)
 		{
-			Data.erase(Key);
-			bIsDirty =  true;
+			if (!RelayClient.Send(Heartbeat, Heartbeat.Project))
+			{
+				NotRelayed.push_back(Heartbeat);
+			}
 		}
-	} else
-	{
-		if(!Data.contains(Key))
-		{
-			Data.insert(std::make_pair(Key, Value));
-			bIsDirty =  true;
-		} else if(!Data[Key].compare(Value))
+
+		if (!NotRelayed.empty())
 		{
-			Data[Key] = Value;
-			bIsDirty =  true;
+			LaunchHeartbeatProcess(NotRelayed);
 		}
+		return;
 	}
+
+	LaunchHeartbeatProcess(Heartbeats);
 }
 
-// Lifecycle methods
-void FWakaTimeForUEModule::SendHeartbeat(bool bFileSave, string Activity, string EntityType, FString Entity, string Language)
+void FWakaTimeForUEModule::LaunchHeartbeatProcess(const std::vector<FWakaTimeHeartbeat>& Heartbeats)
 {
 	UE_LOG(LogWakaTime, Log, TEXT("Sending Heartbeat"));
 
-	string Command = GBaseCommand;
+	// The supervisor reaps the process later, so the editor never waits for the cli here
+	if (!ProcessSupervisor.Launch(BuildHeartbeatRequest(Heartbeats)))
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("Heartbeat couldn't be sent."));
+	}
+}
 
-	Command += " --config " + string(GUserProfile) + "\\.wakatime.cfg ";
-	Command += "--log-file " + string(GUserProfile) + "\\.wakatime\\wakatime.log ";
+FWakaTimeCliSettings FWakaTimeForUEModule::GetCliSettings()
+{
+	FWakaTimeCliSettings Settings;
+	Settings.ConfigPath = string(GUserProfile) + "\\.wakatime.cfg";
+	Settings.LogPath = string(GUserProfile) + "\\.wakatime\\wakatime.log";
+	Settings.ApiUrl = GAPIUrl;
+	Settings.ProjectFolder = GProjectPath;
+	Settings.Plugin = "unreal-wakatime/" + GPluginVersion;
+	return Settings;
+}
 
-	if(GAPIUrl != "")
+FWakaTimeProcessRequest FWakaTimeForUEModule::BuildHeartbeatRequest(const std::vector<FWakaTimeHeartbeat>& Heartbeats)
+{
+	FWakaTimeCommand Command = FWakaTimeCommandBuilder::BuildHeartbeats(GetCliSettings(), Heartbeats);
+
+	FWakaTimeProcessRequest Request;
+	Request.ExeToRun = GBaseCommand;
+	Request.CommandToRun = Command.ToCommandLine();
+	Request.StdinData = Command.StdinData;
+	Request.Label = "heartbeat " + Heartbeats.front().Activity;
+	Request.Heartbeats = Heartbeats;
+	if (Heartbeats.size() > 1)
 	{
-		Command += "--api-url " + GAPIUrl + " ";
+		Request.Label += " and " + to_string(Heartbeats.size() - 1) + " more";
 	}
+	return Request;
+}
+
+// Event methods
+void FWakaTimeForUEModule::HandleEditorEvent(EWakaTimeEvent Event, const FString& Argument, double Time)
+{
+	if (!EventTrace.IsReplaying())
+	{
+		EventTrace.Record(Event, Argument);
+	}
+
+	if (Event == EWakaTimeEvent::LevelAddedToWorld)
+	{
+		// panning through a World Partition map streams in hundreds of cells; those only cost the counter
+		EWakaTimeLevelSource Source = ParseLevelSource(Argument);
+		NumLevelAdditions[static_cast<int32>(Source)]++;
+		if (Source != EWakaTimeLevelSource::User)
+		{
+			return;
+		}
+	}
+
+	// the policy clock follows the event times, so an accelerated replay filters the same events as the live editor did
+	double EventTime = Time > 0.0 ? Time : FWakaTimeHeartbeatScheduler::Now();
 
-	Command += "--project \"" + GetProjectName() + "\" ";
-	Command += "--project-folder " + GProjectPath + " ";
-	string EntityStr = TCHAR_TO_UTF8(*Entity.Replace(TEXT("/"), TEXT("\\")));
-	Command += "--entity " + EntityStr + " ";
-	Command += "--entity-type \"" + EntityType + "\" ";
-	Command += "--language \"" + Language + "\" ";
-	Command += "--plugin \"unreal-wakatime/" + GPluginVersion + "\" ";
-	Command += "--category " + Activity + " ";
+	switch (Event)
+	{
+	case EWakaTimeEvent::ActorsDropped:
+	case EWakaTimeEvent::ActorsDuplicated:
+	case EWakaTimeEvent::ActorsDeleted:
+		// each of these is also an undo transaction, which reports the level the actors belong to
+		if (!bTrackTransactions)
+		{
+			SendEventHeartbeat(Event, EventTime, false, "app", "Unreal Editor", "Unreal Editor");
+		}
+		break;
+	case EWakaTimeEvent::LevelAddedToWorld:
+	case EWakaTimeEvent::AssetOpened:
+	case EWakaTimeEvent::AssetClosed:
+	case EWakaTimeEvent::PieStarted:
+		SendEventHeartbeat(Event, EventTime, false, "app", "Unreal Editor", "Unreal Editor");
+		break;
+	case EWakaTimeEvent::TransactionCommitted:
+		// the packages it marked are reported by the activity tracker as PropertiesEdited, which the trace holds as well;
+		// sending anything here would make a replay send more than the live editor did
+		break;
+	case EWakaTimeEvent::WorldSaved:
+	case EWakaTimeEvent::PieEnded:
+		SendEventHeartbeat(Event, EventTime, true, "app", "Unreal Editor", "Unreal Editor");
+		break;
+	case EWakaTimeEvent::BlueprintCompiled:
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 4 // RedTheKitsune(OnAssetClosedInEditor is not available in <UE5.4, so blueprint name tracking will not work properly)
+		if (!Argument.IsEmpty()) // empty for blueprints compiled without being opened
+		{
+			SendEventHeartbeat(Event, EventTime, true, "file", Argument, "Blueprints");
+		}
+#else
+		SendEventHeartbeat(Event, EventTime, true, "app", "Unreal Editor", "Blueprints");
+#endif
+		break;
+	case EWakaTimeEvent::PropertiesEdited:
+		SendEventHeartbeat(Event, EventTime, false, "file", Argument, "Unreal Editor");
+		break;
+	default:
+		break;
+	}
+}
 
-	if (bFileSave)
+void FWakaTimeForUEModule::SendEventHeartbeat(EWakaTimeEvent Event, double Time, bool bFileSave, string EntityType,
+                                              FString Entity, string Language)
+{
+	if (!PassesEventPolicy(Event, Time))
 	{
-		Command += "--write";
+		return;
 	}
 
-	bool bSuccess = false;
-	try
+	const FWakaTimeEventPolicy& Policy = EventPolicies[static_cast<int32>(Event)];
+	SendHeartbeat(bFileSave, Policy.Category, EntityType, Entity, Language, Time, Policy.bHighPriority);
+}
+
+bool FWakaTimeForUEModule::PassesEventPolicy(EWakaTimeEvent Event, double Time)
+{
+	int32 Index = static_cast<int32>(Event);
+	const FWakaTimeEventPolicy& Policy = EventPolicies[Index];
+
+	if (!Policy.bEnabled)
 	{
-		bSuccess = FWakaTimeHelpers::RunPowershellCommand(Command, false, INFINITE, true);
+		return false;
 	}
-	catch (int Err)
+
+	if (Policy.MinIntervalSeconds > 0.0 && Time - LastEventHeartbeatTimes[Index] < Policy.MinIntervalSeconds)
 	{
-		UE_LOG(LogWakaTime, Warning, TEXT("%i"), Err);
+		NumEventsFilteredByPolicy++;
+		return false;
 	}
 
-	//bool success = RunCommand(command, false, baseCommand,INFINITE, true);
-	if (bSuccess)
+	if (Policy.SampleRate < 1.0f && FMath::FRand() >= Policy.SampleRate)
 	{
-		UE_LOG(LogWakaTime, Log, TEXT("Heartbeat successfully sent."));
+		NumEventsFilteredByPolicy++;
+		return false;
 	}
-	else
+
+	LastEventHeartbeatTimes[Index] = Time;
+	return true;
+}
+
+void FWakaTimeForUEModule::LoadEventPolicies(const FWakaTimeConfig& Config)
+{
+	for (int32 Index = 0; Index < static_cast<int32>(EWakaTimeEvent::Count); Index++)
 	{
-		UE_LOG(LogWakaTime, Error, TEXT("Heartbeat couldn't be sent."));
-		UE_LOG(LogWakaTime, Error, TEXT("Error code = %d"), GetLastError());
+		EWakaTimeEvent Event = static_cast<EWakaTimeEvent>(Index);
+		FWakaTimeEventPolicy Default;
+
+		switch (Event)
+		{
+		case EWakaTimeEvent::PieStarted:
+		case EWakaTimeEvent::PieEnded:
+			Default.Category = "debugging";
+			break;
+		case EWakaTimeEvent::BlueprintCompiled:
+			Default.Category = "coding";
+			break;
+		case EWakaTimeEvent::AssetOpened:
+		case EWakaTimeEvent::AssetClosed:
+			Default.Category = "designing";
+			Default.bEnabled = false; // opening an asset is not working on it
+			break;
+		default:
+			Default.Category = "designing";
+			break;
+		}
+
+		EventPolicies[Index] = FWakaTimeEventPolicy::Load(Config, "unreal", TCHAR_TO_UTF8(GetWakaTimeEventName(Event)), Default);
 	}
 }
 
-// Event methods
 void FWakaTimeForUEModule::OnNewActorDropped(const TArray<UObject*>& Objects, const TArray<AActor*>& Actors)
 {
-	SendHeartbeat(false, "designing", "app", "Unreal Editor", "Unreal Editor");
+	HandleEditorEvent(EWakaTimeEvent::ActorsDropped, FString::FromInt(Actors.Num()));
 }
 
 void FWakaTimeForUEModule::OnDuplicateActorsEnd()
 {
-	SendHeartbeat(false, "designing", "app", "Unreal Editor", "Unreal Editor");
+	HandleEditorEvent(EWakaTimeEvent::ActorsDuplicated, FString());
 }
 
 void FWakaTimeForUEModule::OnDeleteActorsEnd()
 {
-	SendHeartbeat(false, "designing", "app", "Unreal Editor", "Unreal Editor");
+	HandleEditorEvent(EWakaTimeEvent::ActorsDeleted, FString());
 }
 
 void FWakaTimeForUEModule::OnAddLevelToWorld(ULevel* Level)
 {
-	SendHeartbeat(false, "designing", "app", "Unreal Editor", "Unreal Editor");
+	// every addition is handed on, so the trace holds the levels streamed in as well and a replay reproduces the load
+	EWakaTimeLevelSource Source = ClassifyLevelAddition(Level);
+	HandleEditorEvent(EWakaTimeEvent::LevelAddedToWorld, FString(GLevelSourceNames[static_cast<int32>(Source)]) + TEXT(" ") +
+	                  (Level ? Level->GetOutermost()->GetName() : FString()));
+}
+
+EWakaTimeLevelSource FWakaTimeForUEModule::ClassifyLevelAddition(const ULevel* Level)
+{
+	if (!Level)
+	{
+		return EWakaTimeLevelSource::Streaming;
+	}
+
+	const UWorld* OwningWorld = Level->OwningWorld;
+	if (Level->GetOutermost()->HasAnyPackageFlags(PKG_PlayInEditor) || (OwningWorld && OwningWorld->IsPlayInEditor()))
+	{
+		return EWakaTimeLevelSource::PlayInEditor;
+	}
+
+	// the Levels window adds a level through a new streaming level; a level without one was loaded some other way
+	const ULevelStreaming* StreamingLevel = ULevelStreaming::FindStreamingLevel(Level);
+	if (!StreamingLevel)
+	{
+		return EWakaTimeLevelSource::Streaming;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5 // World Partition and level instances do not exist before UE5
+	if (StreamingLevel->IsA<UWorldPartitionLevelStreamingDynamic>())
+	{
+		return EWakaTimeLevelSource::WorldPartition;
+	}
+
+	if (StreamingLevel->IsA<ULevelStreamingLevelInstance>() || StreamingLevel->IsA<ULevelStreamingLevelInstanceEditor>())
+	{
+		return EWakaTimeLevelSource::Streaming;
+	}
+#endif
+
+	return EWakaTimeLevelSource::User;
 }
 
 #if ENGINE_MAJOR_VERSION == 5
 	void FWakaTimeForUEModule::OnPostSaveWorld(UWorld* World, FObjectPostSaveContext Context)
 	{
-		SendHeartbeat(true, "designing", "app", "Unreal Editor", "Unreal Editor");
+		HandleEditorEvent(EWakaTimeEvent::WorldSaved, World ? World->GetOutermost()->GetName() : FString());
 }
 #else
 	void FWakaTimeForUEModule::OnPostSaveWorld(uint32 SaveFlags, UWorld* World, bool bSucces)
 	{
-		SendHeartbeat(true, "designing", "app", "Unreal Editor", "Unreal Editor");
+		HandleEditorEvent(EWakaTimeEvent::WorldSaved, World ? World->GetOutermost()->GetName() : FString());
 	}
 #endif
 
 void FWakaTimeForUEModule::OnPostPieStarted(bool bIsSimulating)
 {
-	SendHeartbeat(false, "debugging", "app", "Unreal Editor", "Unreal Editor");
+	HandleEditorEvent(EWakaTimeEvent::PieStarted, bIsSimulating ? TEXT("1") : TEXT("0"));
+
+	// a session whose end was never broadcast is closed first, so its ticker is not left running next to the new one
+	StopPieSession();
+
+	// only a timestamp; nothing runs during the session's frames but a ticker check every few minutes
+	PieSession.Start(FWakaTimeHeartbeatScheduler::Now());
+#if ENGINE_MAJOR_VERSION >= 5
+	PieSessionTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float)
+	{
+		SendPieSessionHeartbeats(PieSession.Advance(FWakaTimeHeartbeatScheduler::Now()));
+		return true;
+	}), GPieBatchSeconds);
+#else // FTSTicker does not exist before UE5
+	PieSessionTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float)
+	{
+		SendPieSessionHeartbeats(PieSession.Advance(FWakaTimeHeartbeatScheduler::Now()));
+		return true;
+	}), GPieBatchSeconds);
+#endif
 }
 
 void FWakaTimeForUEModule::OnPrePieEnded(bool bIsSimulating)
 {
-	SendHeartbeat(true, "debugging", "app", "Unreal Editor", "Unreal Editor");
+	StopPieSession();
+	HandleEditorEvent(EWakaTimeEvent::PieEnded, bIsSimulating ? TEXT("1") : TEXT("0"));
+}
+
+void FWakaTimeForUEModule::StopPieSession()
+{
+	if (!PieSession.IsActive())
+	{
+		return;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(PieSessionTickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(PieSessionTickerHandle);
+#endif
+
+	SendPieSessionHeartbeats(PieSession.Stop(FWakaTimeHeartbeatScheduler::Now()));
+}
+
+void FWakaTimeForUEModule::SendPieSessionHeartbeats(const std::vector<double>& Times)
+{
+	if (Times.empty())
+	{
+		return;
+	}
+
+	FWakaTimeHeartbeat Heartbeat;
+	Heartbeat.Activity = "debugging";
+	Heartbeat.EntityType = "app";
+	Heartbeat.Entity = "Unreal Editor";
+	Heartbeat.Language = "Unreal Editor";
+	Heartbeat.Project = GetProjectName();
+
+	// identical but for the time, the scheduler would merge them into one; they go out together in a single call instead
+	std::vector<FWakaTimeHeartbeat> Heartbeats(Times.size(), Heartbeat);
+	for (size_t Index = 0; Index < Times.size(); Index++)
+	{
+		Heartbeats[Index].Time = Times[Index];
+	}
+
+	NumPieSessionHeartbeats += static_cast<uint32>(Heartbeats.size());
+	LaunchHeartbeats(Heartbeats);
 }
 
 void FWakaTimeForUEModule::OnBlueprintPreCompile(UBlueprint* Blueprint)
@@ -600,20 +1186,65 @@ void FWakaTimeForUEModule::OnBlueprintPreCompile(UBlueprint* Blueprint)
 			return *BPName == Blueprint->GetName();
 		});
 	
-	if(!Found) return;
+	if(!Found)
+	{
+		HandleEditorEvent(EWakaTimeEvent::BlueprintCompiled, FString());
+		return;
+	}
 
 	FString PackageName = Blueprint->GetOutermost()->GetName();
 	FString FilePath = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
  
-	SendHeartbeat(true, "coding", "file", TCHAR_TO_UTF8(*FilePath), "Blueprints");
+	HandleEditorEvent(EWakaTimeEvent::BlueprintCompiled, FilePath);
 #else
-	SendHeartbeat(true, "coding", "app", "Unreal Editor", "Blueprints");
+	HandleEditorEvent(EWakaTimeEvent::BlueprintCompiled, FString());
 #endif
 }
 
+void FWakaTimeForUEModule::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// fires for every step of a slider drag; only a mark here, the tracker turns it into one heartbeat per package and interval
+	ActivityTracker.MarkObject(Object);
+}
+
+void FWakaTimeForUEModule::OnTransactionStateChanged(const FTransactionContext& TransactionContext,
+                                                     ETransactionStateEventType TransactionState)
+{
+	if (TransactionState != ETransactionStateEventType::TransactionFinalized &&
+		TransactionState != ETransactionStateEventType::UndoRedoFinalized)
+	{
+		return; // started and canceled transactions did not change anything (yet)
+	}
+
+	// the tracker is the only thing a transaction feeds, so a disabled policy has to stop the marks
+	if (!EventPolicies[static_cast<int32>(EWakaTimeEvent::TransactionCommitted)].bEnabled)
+	{
+		return;
+	}
+
+	int32 TransactionIndex = GEditor->Trans->FindTransactionIndex(TransactionContext.TransactionId);
+	if (const FTransaction* Transaction = GEditor->Trans->GetTransaction(TransactionIndex))
+	{
+		TArray<UObject*> TransactionObjects;
+		Transaction->GetTransactionObjects(TransactionObjects);
+		for (const UObject* Object : TransactionObjects)
+		{
+			ActivityTracker.MarkObject(Object);
+		}
+	}
+	else
+	{
+		ActivityTracker.MarkObject(TransactionContext.PrimaryObject);
+	}
+
+	HandleEditorEvent(EWakaTimeEvent::TransactionCommitted, TransactionContext.Title.ToString());
+}
+
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 4 // RedTheKitsune(OnAssetClosedInEditor is not available in <UE5.4, so blueprint name tracking will not work properly)
 void FWakaTimeForUEModule::OnAssetOpened(UObject* Asset, IAssetEditorInstance* AssetEditor)
 {
+	HandleEditorEvent(EWakaTimeEvent::AssetOpened, Asset->GetPathName());
+
 	if(!Asset->IsA<UBlueprint>()) return;
 	
 	OpenedBPs.Add(MakeShared<FString>(Asset->GetName()));
@@ -621,6 +1252,8 @@ void FWakaTimeForUEModule::OnAssetOpened(UObject* Asset, IAssetEditorInstance* A
 
 void FWakaTimeForUEModule::OnAssetClosed(UObject* Asset, IAssetEditorInstance* AssetEditor)
 {
+	HandleEditorEvent(EWakaTimeEvent::AssetClosed, Asset->GetPathName());
+
 	if(!Asset->IsA<UBlueprint>()) return;
 	
 	OpenedBPs.RemoveAll([Asset](const TSharedRef<FString>& BPName)
@@ -643,6 +1276,17 @@ void FWakaTimeForUEModule::OnEditorInitialized(double TimeToInitializeEditor)
 #endif
 		
 		OnBlueprintPreCompileHandle = GEditor->OnBlueprintPreCompile().AddRaw(this, &FWakaTimeForUEModule::OnBlueprintPreCompile);
+
+		if (UTransBuffer* TransBuffer = Cast<UTransBuffer>(GEditor->Trans))
+		{
+			TransactionStateChangedHandle = TransBuffer->OnTransactionStateChanged().AddRaw(
+				this, &FWakaTimeForUEModule::OnTransactionStateChanged);
+			bTrackTransactions = true;
+		}
+		else
+		{
+			UE_LOG(LogWakaTime, Warning, TEXT("No undo buffer present, falling back to the actor delegates"));
+		}
 	}
 	else
 	{
@@ -0,0 +1,136 @@
+#include "WakaTimeHeartbeatScheduler.h"
+
+#include "WakaTimeForUE.h"
+#include "Editor.h"
+#include "Framework/Application/SlateApplication.h"
+
+// Weight of the newest frame in the smoothed frame time
+static constexpr double GFrameSmoothing = 0.1;
+
+void FWakaTimeHeartbeatScheduler::Initialize(TFunction<void(const FWakaTimeHeartbeat&)> InOnDispatch,
+                                             TFunction<void(const FWakaTimeHeartbeat&)> InOnWriteOverflow,
+                                             TFunction<bool()> InIsSinkSaturated, double InFrameBudgetSeconds,
+                                             double InMaxDelaySeconds)
+{
+	OnDispatch = MoveTemp(InOnDispatch);
+	OnWriteOverflow = MoveTemp(InOnWriteOverflow);
+	IsSinkSaturated = MoveTemp(InIsSinkSaturated);
+	FrameBudgetSeconds = InFrameBudgetSeconds;
+	Queue.SetMaxDelay(InMaxDelaySeconds);
+	SmoothedFrameSeconds = FrameBudgetSeconds;
+
+	// the ticker runs every frame, as it has to see the frame times; it does nothing else while the queue is empty
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeHeartbeatScheduler::Tick));
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeHeartbeatScheduler::Tick));
+#endif
+}
+
+void FWakaTimeHeartbeatScheduler::Shutdown()
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	DispatchAll();
+	LogStats();
+}
+
+void FWakaTimeHeartbeatScheduler::Enqueue(const FWakaTimeHeartbeat& Heartbeat, bool bUrgent)
+{
+	if (bUrgent)
+	{
+		NumUrgent++;
+		OnDispatch(Heartbeat);
+		return;
+	}
+
+	if (Queue.Enqueue(Heartbeat, FPlatformTime::Seconds()) == EWakaTimeEnqueueResult::WriteLaneFull)
+	{
+		OnWriteOverflow(Heartbeat);
+	}
+}
+
+void FWakaTimeHeartbeatScheduler::DispatchAll()
+{
+	for (const FWakaTimeHeartbeat& Heartbeat : Queue.TakeAll())
+	{
+		OnDispatch(Heartbeat);
+	}
+}
+
+std::vector<FWakaTimeHeartbeat> FWakaTimeHeartbeatScheduler::TakePending()
+{
+	return Queue.TakeAll();
+}
+
+void FWakaTimeHeartbeatScheduler::LogStats() const
+{
+	const FWakaTimeDispatchQueue::FStats& Stats = Queue.GetStats();
+	UE_LOG(LogWakaTime, Log,
+	       TEXT("Scheduler: %u urgent, %u queued heartbeats, %u merged, %u deferred, %u forced by max delay, longest delay %.1f s"),
+	       NumUrgent, Stats.NumEnqueued, Stats.NumMerged, Stats.NumDeferred, Stats.NumForcedByMaxDelay,
+	       Stats.LongestDelaySeconds);
+	UE_LOG(LogWakaTime, Log,
+	       TEXT("Scheduler lanes: %u informational shed, %u saves overflowed, peak %u saves and %u informational waiting, %llu bytes of slots, %u saturated frames"),
+	       Stats.NumShed, Stats.NumWriteOverflows, Stats.PeakWrite, Stats.PeakInfo,
+	       static_cast<uint64>(Queue.GetSlotBytes()), NumSaturatedFrames);
+}
+
+double FWakaTimeHeartbeatScheduler::Now()
+{
+	return (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTotalSeconds();
+}
+
+bool FWakaTimeHeartbeatScheduler::Tick(float DeltaTime)
+{
+	SmoothedFrameSeconds += (DeltaTime - SmoothedFrameSeconds) * GFrameSmoothing;
+
+	if (Queue.IsEmpty())
+	{
+		return true;
+	}
+
+	// backpressure: heartbeats wait here, where the lanes decide what to keep, instead of piling up behind the processes
+	if (IsSinkSaturated())
+	{
+		NumSaturatedFrames++;
+		return true;
+	}
+
+	double Now = FPlatformTime::Seconds();
+	bool bBusy = !Queue.IsOldestOverdue(Now) && IsEditorBusy();
+
+	// one heartbeat per frame, so a burst of events does not turn into a burst of process spawns
+	FWakaTimeHeartbeat Heartbeat;
+	if (Queue.PopReady(Now, bBusy, Heartbeat))
+	{
+		OnDispatch(Heartbeat);
+	}
+
+	return true;
+}
+
+bool FWakaTimeHeartbeatScheduler::IsEditorBusy() const
+{
+	if (FSlateApplication::IsInitialized())
+	{
+		double SinceInput = FPlatformTime::Seconds() - FSlateApplication::Get().GetLastUserInteractionTime();
+		if (SinceInput >= IdleAfterSeconds)
+		{
+			return false; // nobody is looking, a hitch would go unnoticed (also covers the throttled background editor)
+		}
+	}
+
+	if (GEditor && GEditor->PlayWorld)
+	{
+		return true;
+	}
+
+	return SmoothedFrameSeconds > FrameBudgetSeconds;
+}
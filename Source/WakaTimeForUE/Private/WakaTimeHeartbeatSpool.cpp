@@ -0,0 +1,52 @@
+#include "WakaTimeHeartbeatSpool.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeJson.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+bool FWakaTimeHeartbeatSpool::Append(const FString& Path, const std::vector<FWakaTimeHeartbeat>& Heartbeats)
+{
+	std::string Lines;
+	for (const FWakaTimeHeartbeat& Heartbeat : Heartbeats)
+	{
+		Lines += FWakaTimeJson::ToJson(Heartbeat);
+		Lines += '\n';
+	}
+
+	IFileHandle* FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Path, true);
+	if (!FileHandle)
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("Could not open %s, %d heartbeats are lost"), *Path,
+		       static_cast<int32>(Heartbeats.size()));
+		return false;
+	}
+
+	bool bWritten = FileHandle->Write(reinterpret_cast<const uint8*>(Lines.data()), Lines.size());
+	delete FileHandle;
+	return bWritten;
+}
+
+std::vector<FWakaTimeHeartbeat> FWakaTimeHeartbeatSpool::Take(const FString& Path)
+{
+	std::vector<FWakaTimeHeartbeat> Heartbeats;
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+	{
+		return Heartbeats;
+	}
+	IFileManager::Get().Delete(*Path);
+
+	for (const FString& Line : Lines)
+	{
+		// a line that cannot be parsed is most likely the last one of a file that was being written when the editor crashed
+		FWakaTimeHeartbeat Heartbeat;
+		if (!Line.IsEmpty() && FWakaTimeJson::FromJson(TCHAR_TO_UTF8(*Line), Heartbeat))
+		{
+			Heartbeats.push_back(Heartbeat);
+		}
+	}
+
+	return Heartbeats;
+}
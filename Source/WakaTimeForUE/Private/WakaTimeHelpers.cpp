@@ -46,26 +46,34 @@ bool FWakaTimeHelpers::RunCommand(std::string CommandToRun, bool bRequireNonZero
 	                              &Startupinfo, // Pointer to STARTUPINFO structure
 	                              &Process_Information); // Pointer to PROCESS_INFORMATION structure
 
-	// Close process and thread handles.
-	bool bReturnValue;
+	if (!bSuccess)
+	{
+		return false;
+	}
 
-	if (bRequireNonZeroProcess)
+	bool bReturnValue = true;
+
+	// a process that is waited for and outlives the wait is given up on; it must not keep writing what the caller reads next
+	if (WaitMs != 0 && WaitForSingleObject(Process_Information.hProcess, WaitMs) == WAIT_TIMEOUT)
 	{
-		DWORD ExitCode;
-		GetExitCodeProcess(Process_Information.hProcess, &ExitCode);
-		bReturnValue = (ExitCode == 0);
+		UE_LOG(LogWakaTime, Warning, TEXT("Command did not finish within %d ms, terminating it"), WaitMs);
+		TerminateProcess(Process_Information.hProcess, 1);
+		WaitForSingleObject(Process_Information.hProcess, INFINITE);
+		bReturnValue = false;
 	}
-	else
+	else if (bRequireNonZeroProcess && WaitMs != 0)
 	{
-		bReturnValue = true;
+		// the exit code is only known once the process exited
+		DWORD ExitCode = 1;
+		GetExitCodeProcess(Process_Information.hProcess, &ExitCode);
+		bReturnValue = (ExitCode == 0);
 	}
 
-	WaitForSingleObject(Process_Information.hProcess, WaitMs);
-	
+	// Close process and thread handles.
 	CloseHandle(Process_Information.hThread);
 	CloseHandle(Process_Information.hProcess);
 
-	return bSuccess && bReturnValue;
+	return bReturnValue;
 }
 
 
@@ -92,7 +100,7 @@ bool FWakaTimeHelpers::UnzipArchive(std::string ZipFile, std::string SavePath)
 	if (!PathExists(ZipFile)) return false;
 
 	std::string ExtractCommand = "powershell -command \"Expand-Archive -Force \"" + ZipFile + "\" \"" + SavePath + "\"";
-	return RunPowershellCommand(ExtractCommand, false, INFINITE, true);
+	return RunPowershellCommand(ExtractCommand, true, INFINITE, true);
 }
 
 
@@ -103,5 +111,5 @@ bool FWakaTimeHelpers::DownloadFile(std::string URL, std::string SaveTo)
 		SaveTo + "')\"";
 
 	UE_LOG(LogWakaTime, Warning, TEXT("%s"), *FString(UTF8_TO_TCHAR(DownloadCommand.c_str())));
-	return RunPowershellCommand(DownloadCommand, false, INFINITE, true);
+	return RunPowershellCommand(DownloadCommand, true, INFINITE, true);
 }
@@ -0,0 +1,381 @@
+#include "WakaTimeProcessSupervisor.h"
+
+#include <algorithm>
+
+#include "WakaTimeForUE.h"
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include "Windows/WindowsHWrapper.h"
+
+// Exit code given to processes terminated by the supervisor, so they are recognizable in the wakatime log
+static constexpr uint32 GKilledExitCode = 0xDEAD;
+
+// Exit codes of wakatime-cli after which the heartbeats are kept in the cli's own offline queue, to be sent later
+static constexpr uint32 GCliExitApiError = 102;
+static constexpr uint32 GCliExitBackoff = 112;
+
+// How often the supervisor checks on its processes
+static constexpr float GReapIntervalSeconds = 0.25f;
+
+void FWakaTimeProcessSupervisor::Initialize(TFunction<void(const std::vector<FWakaTimeHeartbeat>&)> InOnWriteOverflow,
+                                            int32 InMaxInFlight, double InTimeoutSeconds, double InSlowSeconds)
+{
+	OnWriteOverflow = MoveTemp(InOnWriteOverflow);
+	MaxInFlight = FMath::Max(1, InMaxInFlight);
+	TimeoutSeconds = InTimeoutSeconds;
+	SlowSeconds = InSlowSeconds;
+
+	JobHandle = CreateJobObject(nullptr, nullptr);
+	if (JobHandle)
+	{
+		// A crashing cli would otherwise sit on the Windows error reporting dialog until the deadline
+		JOBOBJECT_EXTENDED_LIMIT_INFORMATION Limits;
+		ZeroMemory(&Limits, sizeof(Limits));
+		Limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_DIE_ON_UNHANDLED_EXCEPTION;
+		SetInformationJobObject(JobHandle, JobObjectExtendedLimitInformation, &Limits, sizeof(Limits));
+	}
+	else
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("Could not create job object, error code = %d"), GetLastError());
+	}
+
+	InFlight.reserve(MaxInFlight);
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeProcessSupervisor::Tick), GReapIntervalSeconds);
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeProcessSupervisor::Tick), GReapIntervalSeconds);
+#endif
+}
+
+void FWakaTimeProcessSupervisor::Shutdown()
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	Reap();
+	LogStats();
+
+	for (FTrackedProcess& Process : InFlight)
+	{
+		CloseTrackedProcess(Process);
+	}
+	InFlight.clear();
+
+	if (!Queued.empty())
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("%d queued processes were not started before shutdown"),
+		       static_cast<int32>(Queued.size()));
+		Queued.clear();
+	}
+
+	if (JobHandle)
+	{
+		CloseHandle(JobHandle);
+		JobHandle = nullptr;
+	}
+}
+
+bool FWakaTimeProcessSupervisor::Launch(const FWakaTimeProcessRequest& Request)
+{
+	if (GetInFlightCount() < MaxInFlight)
+	{
+		return StartProcess(Request);
+	}
+
+	if (GetQueuedCount() >= MaxQueued)
+	{
+		// the oldest request is the least relevant one, as the newer ones cover the same time span;
+		// saves are never dropped, a file that was written but never reported is missing from the dashboard for good
+		auto Evicted = std::find_if(Queued.begin(), Queued.end(),
+		                            [](const FWakaTimeProcessRequest& Candidate) { return !ContainsWrite(Candidate); });
+		if (Evicted != Queued.end())
+		{
+			UE_LOG(LogWakaTime, Warning, TEXT("Process queue is full, dropping \"%s\""),
+			       *FString(UTF8_TO_TCHAR(Evicted->Label.c_str())));
+			Queued.erase(Evicted);
+			NumDropped++;
+		}
+		else if (!ContainsWrite(Request))
+		{
+			UE_LOG(LogWakaTime, Warning, TEXT("Process queue is full of saves, dropping \"%s\""),
+			       *FString(UTF8_TO_TCHAR(Request.Label.c_str())));
+			NumDropped++;
+			return false;
+		}
+		else
+		{
+			// the queue keeps its fixed size; the save is kept on disk and sent on the next launch
+			UE_LOG(LogWakaTime, Warning, TEXT("Process queue is full of saves, keeping \"%s\" for the next launch"),
+			       *FString(UTF8_TO_TCHAR(Request.Label.c_str())));
+			NumOverflowed++;
+			if (OnWriteOverflow)
+			{
+				OnWriteOverflow(Request.Heartbeats);
+			}
+			return true;
+		}
+	}
+
+	Queued.push_back(Request);
+	return true;
+}
+
+bool FWakaTimeProcessSupervisor::IsHeartbeatExitSafe(uint32 ExitCode)
+{
+	return ExitCode == 0 || ExitCode == GCliExitApiError || ExitCode == GCliExitBackoff;
+}
+
+bool FWakaTimeProcessSupervisor::ContainsWrite(const FWakaTimeProcessRequest& Request)
+{
+	return std::any_of(Request.Heartbeats.begin(), Request.Heartbeats.end(),
+	                   [](const FWakaTimeHeartbeat& Heartbeat) { return Heartbeat.bFileSave; });
+}
+
+bool FWakaTimeProcessSupervisor::StartProcess(const FWakaTimeProcessRequest& Request)
+{
+	// the command line has to start with the exe itself, otherwise the first argument is treated as the program name
+	std::string CommandLine = "\"" + Request.ExeToRun + "\" " + Request.CommandToRun;
+
+	UE_LOG(LogWakaTime, Log, TEXT("Running command: %s"), *FString(UTF8_TO_TCHAR(CommandLine.c_str())));
+
+	STARTUPINFO Startupinfo;
+	PROCESS_INFORMATION Process_Information;
+
+	ZeroMemory(&Startupinfo, sizeof(Startupinfo));
+	Startupinfo.cb = sizeof(Startupinfo);
+	ZeroMemory(&Process_Information, sizeof(Process_Information));
+
+	HANDLE StdinRead = nullptr;
+	HANDLE StdinWrite = nullptr;
+	if (!Request.StdinData.empty())
+	{
+		SECURITY_ATTRIBUTES PipeAttributes;
+		ZeroMemory(&PipeAttributes, sizeof(PipeAttributes));
+		PipeAttributes.nLength = sizeof(PipeAttributes);
+		PipeAttributes.bInheritHandle = true;
+
+		// sized to the data, so writing it does not wait for the process to read
+		if (!CreatePipe(&StdinRead, &StdinWrite, &PipeAttributes, static_cast<DWORD>(Request.StdinData.size())))
+		{
+			UE_LOG(LogWakaTime, Error, TEXT("Could not create the input pipe of \"%s\", error code = %d"),
+			       *FString(UTF8_TO_TCHAR(Request.Label.c_str())), GetLastError());
+			NumFailedToStart++;
+			return false;
+		}
+		SetHandleInformation(StdinWrite, HANDLE_FLAG_INHERIT, 0);
+
+		Startupinfo.dwFlags |= STARTF_USESTDHANDLES;
+		Startupinfo.hStdInput = StdinRead;
+	}
+
+	FString CommandLineW = UTF8_TO_TCHAR(CommandLine.c_str());
+	FString DirectoryW = UTF8_TO_TCHAR(Request.Directory.c_str());
+
+	bool bSuccess = CreateProcess(*FString(UTF8_TO_TCHAR(Request.ExeToRun.c_str())),
+	                              CommandLineW.GetCharArray().GetData(), // CreateProcess may modify the buffer
+	                              nullptr, // Process handle not inheritable
+	                              nullptr, // Thread handle not inheritable
+	                              StdinRead != nullptr, // Only the input pipe needs to be inherited
+	                              CREATE_NO_WINDOW | CREATE_SUSPENDED, // Suspended until it is assigned to the job
+	                              nullptr, // Use parent's environment block
+	                              Request.Directory.empty() ? nullptr : *DirectoryW,
+	                              &Startupinfo, // Pointer to STARTUPINFO structure
+	                              &Process_Information); // Pointer to PROCESS_INFORMATION structure
+
+	if (StdinRead)
+	{
+		CloseHandle(StdinRead);
+	}
+
+	if (!bSuccess)
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("Could not start \"%s\", error code = %d"),
+		       *FString(UTF8_TO_TCHAR(Request.Label.c_str())), GetLastError());
+		if (StdinWrite)
+		{
+			CloseHandle(StdinWrite);
+		}
+		NumFailedToStart++;
+		return false;
+	}
+
+	if (JobHandle && !AssignProcessToJobObject(JobHandle, Process_Information.hProcess))
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("Could not assign process to job object, error code = %d"), GetLastError());
+	}
+
+	ResumeThread(Process_Information.hThread);
+	CloseHandle(Process_Information.hThread);
+
+	if (StdinWrite)
+	{
+		DWORD BytesWritten = 0;
+		if (!WriteFile(StdinWrite, Request.StdinData.data(), static_cast<DWORD>(Request.StdinData.size()), &BytesWritten,
+		               nullptr))
+		{
+			UE_LOG(LogWakaTime, Warning, TEXT("Could not write the input of \"%s\", error code = %d"),
+			       *FString(UTF8_TO_TCHAR(Request.Label.c_str())), GetLastError());
+		}
+		CloseHandle(StdinWrite); // end of input
+	}
+
+	FTrackedProcess Process;
+	Process.ProcessHandle = Process_Information.hProcess;
+	Process.ProcessId = Process_Information.dwProcessId;
+	Process.StartTime = FPlatformTime::Seconds();
+	Process.Label = Request.Label;
+	InFlight.push_back(Process);
+
+	NumLaunched++;
+	PeakInFlight = FMath::Max(PeakInFlight, static_cast<uint32>(InFlight.size()));
+	return true;
+}
+
+bool FWakaTimeProcessSupervisor::LaunchAndWait(const FWakaTimeProcessRequest& Request, double InTimeoutSeconds,
+                                               uint32& OutExitCode)
+{
+	if (!StartProcess(Request))
+	{
+		return false;
+	}
+
+	FTrackedProcess Process = InFlight.back();
+	InFlight.pop_back();
+
+	DWORD WaitMilliseconds = static_cast<DWORD>(FMath::Max(0.0, InTimeoutSeconds) * 1000.0);
+	bool bExited = WaitForSingleObject(Process.ProcessHandle, WaitMilliseconds) == WAIT_OBJECT_0;
+	double Elapsed = FPlatformTime::Seconds() - Process.StartTime;
+	FString Label = UTF8_TO_TCHAR(Process.Label.c_str());
+
+	if (bExited)
+	{
+		DWORD ExitCode = 0;
+		GetExitCodeProcess(Process.ProcessHandle, &ExitCode);
+		OutExitCode = ExitCode;
+
+		UE_LOG(LogWakaTime, Log, TEXT("\"%s\" exited with code %u after %.2f s"), *Label, ExitCode, Elapsed);
+		if (ExitCode != 0 && IsHeartbeatExitSafe(ExitCode))
+		{
+			NumQueuedOffline++;
+		}
+		else if (ExitCode != 0)
+		{
+			NumNonZeroExit++;
+		}
+	}
+	else
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("\"%s\" (pid %u) did not finish in %.2f s, terminating it"), *Label,
+		       Process.ProcessId, InTimeoutSeconds);
+		TerminateProcess(Process.ProcessHandle, GKilledExitCode);
+		NumKilled++;
+	}
+
+	CloseTrackedProcess(Process);
+	return bExited;
+}
+
+std::vector<FWakaTimeProcessRequest> FWakaTimeProcessSupervisor::TakeQueued()
+{
+	std::vector<FWakaTimeProcessRequest> Taken(Queued.begin(), Queued.end());
+	Queued.clear();
+	return Taken;
+}
+
+void FWakaTimeProcessSupervisor::CloseTrackedProcess(FTrackedProcess& Process)
+{
+	if (Process.ProcessHandle)
+	{
+		CloseHandle(Process.ProcessHandle);
+		Process.ProcessHandle = nullptr;
+	}
+}
+
+void FWakaTimeProcessSupervisor::Reap()
+{
+	double Now = FPlatformTime::Seconds();
+
+	for (int32 Index = static_cast<int32>(InFlight.size()) - 1; Index >= 0; Index--)
+	{
+		FTrackedProcess& Process = InFlight[Index];
+		double Elapsed = Now - Process.StartTime;
+		FString Label = UTF8_TO_TCHAR(Process.Label.c_str());
+
+		if (WaitForSingleObject(Process.ProcessHandle, 0) == WAIT_OBJECT_0)
+		{
+			DWORD ExitCode = 0;
+			GetExitCodeProcess(Process.ProcessHandle, &ExitCode);
+
+			if (ExitCode == 0)
+			{
+				UE_LOG(LogWakaTime, Log, TEXT("\"%s\" finished in %.2f s"), *Label, Elapsed);
+			}
+			else if (IsHeartbeatExitSafe(ExitCode))
+			{
+				// the api could not be reached; not a failure of the plugin, the cli sends them with a later call
+				UE_LOG(LogWakaTime, Log, TEXT("\"%s\" queued its heartbeats offline (code %u) after %.2f s"), *Label,
+				       ExitCode, Elapsed);
+				NumQueuedOffline++;
+			}
+			else
+			{
+				UE_LOG(LogWakaTime, Warning, TEXT("\"%s\" exited with code %u after %.2f s"), *Label, ExitCode, Elapsed);
+				NumNonZeroExit++;
+			}
+
+			CloseTrackedProcess(Process);
+			InFlight.erase(InFlight.begin() + Index);
+			continue;
+		}
+
+		if (Elapsed >= TimeoutSeconds)
+		{
+			UE_LOG(LogWakaTime, Warning, TEXT("\"%s\" (pid %u) did not finish in %.0f s, terminating it"), *Label,
+			       Process.ProcessId, TimeoutSeconds);
+			TerminateProcess(Process.ProcessHandle, GKilledExitCode);
+			NumKilled++;
+
+			CloseTrackedProcess(Process);
+			InFlight.erase(InFlight.begin() + Index);
+			continue;
+		}
+
+		if (!Process.bReportedSlow && Elapsed >= SlowSeconds)
+		{
+			UE_LOG(LogWakaTime, Warning, TEXT("\"%s\" (pid %u) is still running after %.0f s"), *Label,
+			       Process.ProcessId, Elapsed);
+			Process.bReportedSlow = true;
+			NumSlow++;
+		}
+	}
+
+	while (!Queued.empty() && GetInFlightCount() < MaxInFlight)
+	{
+		FWakaTimeProcessRequest Request = Queued.front();
+		Queued.pop_front();
+		StartProcess(Request);
+	}
+}
+
+void FWakaTimeProcessSupervisor::LogStats() const
+{
+	UE_LOG(LogWakaTime, Log,
+	       TEXT("Processes: %u launched, %u failed to start, %u queued offline, %u non-zero exits, %u slow, %u killed, %u dropped, %u saves spooled, peak %u in flight"),
+	       NumLaunched, NumFailedToStart, NumQueuedOffline, NumNonZeroExit, NumSlow, NumKilled, NumDropped, NumOverflowed, PeakInFlight);
+}
+
+bool FWakaTimeProcessSupervisor::Tick(float DeltaTime)
+{
+	if (!InFlight.empty() || !Queued.empty())
+	{
+		Reap();
+	}
+	return true;
+}
+
+#include "Windows/HideWindowsPlatformTypes.h"
@@ -0,0 +1,399 @@
+#include "WakaTimeRelayClient.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "WakaTimeRelayProtocol.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "IPAddress.h"
+
+// How often the client tries to send
+static constexpr float GRelayTickSeconds = 0.1f;
+
+// A connection attempt that takes longer than this is given up
+static constexpr double GConnectTimeoutSeconds = 10.0;
+
+void FWakaTimeRelayClient::Initialize(const std::string& RelayUrl, const std::string& InSecret,
+                                      const std::string& InApiKey, const std::string& InPlugin)
+{
+	Host = RelayUrl;
+	Port = WakaTimeRelayProtocol::DefaultPort;
+
+	// tolerate a scheme, the relay only speaks its own protocol anyway
+	size_t SchemeEnd = Host.find("://");
+	if (SchemeEnd != std::string::npos)
+	{
+		Host = Host.substr(SchemeEnd + 3);
+	}
+
+	size_t PortStart = Host.rfind(':');
+	if (PortStart != std::string::npos)
+	{
+		Port = atoi(Host.substr(PortStart + 1).c_str());
+		Host = Host.substr(0, PortStart);
+	}
+
+	if (Host.empty() || Port <= 0)
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("Invalid relay_url \"%s\""), *FString(UTF8_TO_TCHAR(RelayUrl.c_str())));
+		return;
+	}
+
+	Secret = InSecret;
+	ApiKey = InApiKey;
+	Plugin = InPlugin;
+	Machine = TCHAR_TO_UTF8(FPlatformProcess::ComputerName());
+	if (Secret.empty())
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("relay_secret is not set, only a relay listening on localhost will accept the connection"));
+	}
+
+	// resolving can take a while, it is polled from the ticker
+	PendingResolve = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetHostByName(Host.c_str());
+	bEnabled = true;
+
+	UE_LOG(LogWakaTime, Log, TEXT("Sending heartbeats through the relay at %s:%d"), UTF8_TO_TCHAR(Host.c_str()), Port);
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeRelayClient::Tick), GRelayTickSeconds);
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeRelayClient::Tick), GRelayTickSeconds);
+#endif
+}
+
+std::vector<FWakaTimeHeartbeat> FWakaTimeRelayClient::Shutdown()
+{
+	std::vector<FWakaTimeHeartbeat> Unsent;
+	if (!bEnabled)
+	{
+		return Unsent;
+	}
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	if (bConnected)
+	{
+		Flush();
+	}
+
+	// Pending starts at the first record the relay has not fully received, it only holds heartbeat records
+	size_t Start = 0;
+	size_t End;
+	while ((End = Pending.find(WakaTimeRelayProtocol::Terminator, Start)) != std::string::npos)
+	{
+		FWakaTimeHeartbeat Heartbeat;
+		if (ParseHeartbeatRecord(Pending.substr(Start, End - Start), Heartbeat))
+		{
+			Unsent.push_back(Heartbeat);
+		}
+		Start = End + 1;
+	}
+	Pending.clear();
+
+	if (!Unsent.empty())
+	{
+		UE_LOG(LogWakaTime, Log, TEXT("%d heartbeats were not sent to the relay"), static_cast<int32>(Unsent.size()));
+	}
+
+	bConnected = false;
+	Disconnect();
+
+	if (PendingResolve)
+	{
+		// the resolve info can only be deleted once it finished
+		PendingResolve->WaitForCompletion();
+		delete PendingResolve;
+		PendingResolve = nullptr;
+	}
+
+	bEnabled = false;
+	return Unsent;
+}
+
+bool FWakaTimeRelayClient::ParseHeartbeatRecord(const std::string& Record, FWakaTimeHeartbeat& OutHeartbeat)
+{
+	std::vector<std::string> Fields;
+	size_t Start = 0;
+	size_t End;
+	while ((End = Record.find(WakaTimeRelayProtocol::Separator, Start)) != std::string::npos)
+	{
+		Fields.push_back(Record.substr(Start, End - Start));
+		Start = End + 1;
+	}
+	Fields.push_back(Record.substr(Start));
+
+	if (Fields.size() != WakaTimeRelayProtocol::HeartbeatFieldCount || Fields[0].size() != 1 ||
+		Fields[0][0] != WakaTimeRelayProtocol::HeartbeatTag)
+	{
+		return false;
+	}
+
+	OutHeartbeat.Time = atof(Fields[1].c_str());
+	OutHeartbeat.bFileSave = Fields[2] == "1";
+	OutHeartbeat.Activity = Fields[3];
+	OutHeartbeat.EntityType = Fields[4];
+	OutHeartbeat.Language = Fields[5];
+	OutHeartbeat.Project = Fields[6];
+	OutHeartbeat.Entity = Fields[7];
+	return true;
+}
+
+bool FWakaTimeRelayClient::Send(const FWakaTimeHeartbeat& Heartbeat, const std::string& Project)
+{
+	if (!bConnected || Pending.size() > MaxPendingBytes)
+	{
+		return false;
+	}
+
+	Pending += WakaTimeRelayProtocol::HeartbeatTag;
+	WakaTimeRelayProtocol::AppendField(Pending, std::to_string(Heartbeat.Time));
+	WakaTimeRelayProtocol::AppendField(Pending, Heartbeat.bFileSave ? "1" : "0");
+	WakaTimeRelayProtocol::AppendField(Pending, Heartbeat.Activity);
+	WakaTimeRelayProtocol::AppendField(Pending, Heartbeat.EntityType);
+	WakaTimeRelayProtocol::AppendField(Pending, Heartbeat.Language);
+	WakaTimeRelayProtocol::AppendField(Pending, Project);
+	WakaTimeRelayProtocol::AppendField(Pending, Heartbeat.Entity);
+	Pending += WakaTimeRelayProtocol::Terminator;
+
+	Flush();
+	return true;
+}
+
+bool FWakaTimeRelayClient::Tick(float DeltaTime)
+{
+	if (PendingResolve)
+	{
+		if (!PendingResolve->IsComplete())
+		{
+			return true;
+		}
+
+		if (PendingResolve->GetErrorCode() == 0)
+		{
+			Address = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateInternetAddr();
+			Address->SetRawIp(PendingResolve->GetResolvedAddress().GetRawIp());
+			Address->SetPort(Port);
+		}
+		else
+		{
+			UE_LOG(LogWakaTime, Error, TEXT("Could not resolve relay host %s"), UTF8_TO_TCHAR(Host.c_str()));
+		}
+
+		delete PendingResolve;
+		PendingResolve = nullptr;
+	}
+
+	if (!Address.IsValid())
+	{
+		return true;
+	}
+
+	if (!Socket)
+	{
+		if (FPlatformTime::Seconds() >= NextConnectTime)
+		{
+			Connect();
+		}
+		return true;
+	}
+
+	if (!bConnected)
+	{
+		// the timeout covers the handshake as well, a relay that never answers is as good as unreachable
+		if (FPlatformTime::Seconds() - ConnectStartTime > GConnectTimeoutSeconds)
+		{
+			Disconnect();
+			return true;
+		}
+
+		if (!bHandshaking)
+		{
+			ESocketConnectionState State = Socket->GetConnectionState();
+			if (State == SCS_ConnectionError)
+			{
+				Disconnect();
+				return true;
+			}
+			bHandshaking = State == SCS_Connected;
+		}
+
+		if (bHandshaking && !ReadHandshake())
+		{
+			Disconnect();
+			return true;
+		}
+	}
+
+	if (bConnected)
+	{
+		Flush();
+	}
+
+	return true;
+}
+
+void FWakaTimeRelayClient::Connect()
+{
+	Socket = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->CreateSocket(NAME_Stream, TEXT("WakaTimeRelay"), false);
+	if (!Socket)
+	{
+		NextConnectTime = FPlatformTime::Seconds() + ReconnectDelay;
+		return;
+	}
+
+	Socket->SetNonBlocking(true);
+	Socket->SetNoDelay(true);
+	ConnectStartTime = FPlatformTime::Seconds();
+
+	// non-blocking, the ticker picks up the result
+	if (!Socket->Connect(*Address))
+	{
+		Disconnect();
+	}
+}
+
+bool FWakaTimeRelayClient::ReadHandshake()
+{
+	uint8 Buffer[256];
+	int32 BytesRead = 0;
+	uint32 PendingSize = 0;
+
+	while (Socket->HasPendingData(PendingSize) && PendingSize > 0)
+	{
+		if (!Socket->Recv(Buffer, sizeof(Buffer), BytesRead) || BytesRead <= 0)
+		{
+			return false;
+		}
+		ReadBuffer.append(reinterpret_cast<const char*>(Buffer), BytesRead);
+	}
+
+	size_t End;
+	while ((End = ReadBuffer.find(WakaTimeRelayProtocol::Terminator)) != std::string::npos)
+	{
+		std::string Record = ReadBuffer.substr(0, End);
+		ReadBuffer.erase(0, End + 1);
+
+		if (Record.size() == 1 && Record[0] == WakaTimeRelayProtocol::AcceptTag)
+		{
+			UE_LOG(LogWakaTime, Log, TEXT("Connected to the relay"));
+			bHandshaking = false;
+			bConnected = true;
+			ReconnectDelay = MinReconnectSeconds;
+
+			// records cut off by the previous connection are sent again
+			SentBytes = 0;
+			Flush();
+			return true;
+		}
+
+		// C, version, nonce
+		size_t VersionStart = Record.find(WakaTimeRelayProtocol::Separator);
+		size_t NonceStart = VersionStart == std::string::npos ? std::string::npos
+			: Record.find(WakaTimeRelayProtocol::Separator, VersionStart + 1);
+		if (Record.empty() || Record[0] != WakaTimeRelayProtocol::ChallengeTag || NonceStart == std::string::npos)
+		{
+			UE_LOG(LogWakaTime, Error, TEXT("The relay at %s:%d does not speak the relay protocol"), UTF8_TO_TCHAR(Host.c_str()),
+			       Port);
+			return false;
+		}
+
+		int32 RelayVersion = atoi(Record.substr(VersionStart + 1, NonceStart - VersionStart - 1).c_str());
+		if (RelayVersion != WakaTimeRelayProtocol::Version)
+		{
+			UE_LOG(LogWakaTime, Error, TEXT("The relay speaks protocol version %d, this plugin speaks %d"), RelayVersion,
+			       WakaTimeRelayProtocol::Version);
+			return false;
+		}
+
+		std::string Nonce = Record.substr(NonceStart + 1);
+		std::string SealedKey = WakaTimeRelayProtocol::SealApiKey(Secret, Nonce, ApiKey);
+		std::string SealedKeyHex = WakaTimeRelayProtocol::ToHex(reinterpret_cast<const uint8*>(SealedKey.data()),
+		                                                        SealedKey.size());
+
+		std::string Hello(1, WakaTimeRelayProtocol::HelloTag);
+		WakaTimeRelayProtocol::AppendField(Hello, std::to_string(WakaTimeRelayProtocol::Version));
+		WakaTimeRelayProtocol::AppendField(Hello, WakaTimeRelayProtocol::ComputeProof(Secret, Nonce, Plugin, Machine,
+		                                                                              SealedKeyHex));
+		WakaTimeRelayProtocol::AppendField(Hello, Plugin);
+		WakaTimeRelayProtocol::AppendField(Hello, Machine);
+		WakaTimeRelayProtocol::AppendField(Hello, SealedKeyHex);
+		Hello += WakaTimeRelayProtocol::Terminator;
+
+		// a single short record fits into any socket buffer; nothing from Pending goes out before the relay accepted it
+		int32 BytesSent = 0;
+		if (!Socket->Send(reinterpret_cast<const uint8*>(Hello.data()), static_cast<int32>(Hello.size()), BytesSent) ||
+			BytesSent != static_cast<int32>(Hello.size()))
+		{
+			return false;
+		}
+	}
+
+	// a socket that is readable without any data means the relay closed the connection, it refused the hello
+	if (Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::Zero()) && !Socket->HasPendingData(PendingSize))
+	{
+		UE_LOG(LogWakaTime, Error, TEXT("The relay at %s:%d refused the connection, check relay_secret"),
+		       UTF8_TO_TCHAR(Host.c_str()), Port);
+		return false;
+	}
+
+	return true;
+}
+
+void FWakaTimeRelayClient::Disconnect()
+{
+	if (bConnected)
+	{
+		UE_LOG(LogWakaTime, Warning, TEXT("Lost connection to the relay, falling back to the cli"));
+	}
+
+	if (Socket)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+
+	bConnected = false;
+	bHandshaking = false;
+	ReadBuffer.clear();
+	SentBytes = 0;
+	NextConnectTime = FPlatformTime::Seconds() + ReconnectDelay;
+	ReconnectDelay = FMath::Min(ReconnectDelay * 2.0, MaxReconnectSeconds);
+}
+
+void FWakaTimeRelayClient::Flush()
+{
+	while (SentBytes < Pending.size())
+	{
+		int32 BytesSent = 0;
+		bool bSuccess = Socket->Send(reinterpret_cast<const uint8*>(Pending.data()) + SentBytes,
+		                             static_cast<int32>(Pending.size() - SentBytes), BytesSent);
+		if (!bSuccess)
+		{
+			if (ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode() != SE_EWOULDBLOCK)
+			{
+				Disconnect();
+			}
+			break;
+		}
+		if (BytesSent <= 0)
+		{
+			break;
+		}
+		SentBytes += BytesSent;
+	}
+
+	// only complete records are forgotten; a partially sent one is repeated if the connection drops
+	size_t LastTerminator = SentBytes == 0 ? std::string::npos : Pending.rfind(WakaTimeRelayProtocol::Terminator, SentBytes - 1);
+	if (LastTerminator != std::string::npos)
+	{
+		Pending.erase(0, LastTerminator + 1);
+		SentBytes -= LastTerminator + 1;
+	}
+}
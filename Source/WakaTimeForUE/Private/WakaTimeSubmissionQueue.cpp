@@ -0,0 +1,86 @@
+#include "WakaTimeSubmissionQueue.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "Misc/ScopeLock.h"
+
+void FWakaTimeSubmissionQueue::Initialize(TFunction<void(const FWakaTimeActivity&, double)> InOnActivity)
+{
+	OnActivity = MoveTemp(InOnActivity);
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeSubmissionQueue::Tick));
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeSubmissionQueue::Tick));
+#endif
+}
+
+void FWakaTimeSubmissionQueue::Shutdown()
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	Drain();
+	LogStats();
+}
+
+bool FWakaTimeSubmissionQueue::Submit(const FWakaTimeActivity& Activity)
+{
+	double Now = FWakaTimeHeartbeatScheduler::Now();
+
+	FScopeLock ScopeLock(&Lock);
+	NumSubmitted++;
+
+	if (Count == Capacity)
+	{
+		NumDropped++;
+		return false;
+	}
+
+	FSubmittedActivity& Slot = Ring[(Head + Count) & (Capacity - 1)];
+	Slot.Activity = Activity;
+	Slot.Time = Now;
+	Count++;
+	PeakCount = FMath::Max(PeakCount, Count);
+	return true;
+}
+
+void FWakaTimeSubmissionQueue::Drain()
+{
+	check(IsInGameThread());
+
+	// copied out in one go, so submitters on other threads only ever wait for a memcpy-sized critical section
+	FSubmittedActivity Drained[Capacity];
+	int32 NumDrained = 0;
+	{
+		FScopeLock ScopeLock(&Lock);
+		for (; NumDrained < Count; NumDrained++)
+		{
+			Drained[NumDrained] = Ring[(Head + NumDrained) & (Capacity - 1)];
+		}
+		Head = (Head + Count) & (Capacity - 1);
+		Count = 0;
+	}
+
+	for (int32 Index = 0; Index < NumDrained; Index++)
+	{
+		OnActivity(Drained[Index].Activity, Drained[Index].Time);
+	}
+}
+
+void FWakaTimeSubmissionQueue::LogStats() const
+{
+	UE_LOG(LogWakaTime, Log, TEXT("Submitted activities: %llu submitted, %llu dropped (queue full), peak of %d queued"),
+	       NumSubmitted, NumDropped, PeakCount);
+}
+
+bool FWakaTimeSubmissionQueue::Tick(float DeltaTime)
+{
+	Drain();
+	return true;
+}
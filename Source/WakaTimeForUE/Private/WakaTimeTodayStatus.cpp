@@ -0,0 +1,208 @@
+#include "WakaTimeTodayStatus.h"
+
+#include "WakaTimeForUE.h"
+#include "WakaTimeCommand.h"
+#include "Async/Async.h"
+#include "Misc/ScopeLock.h"
+
+// How often the ticker checks whether a refresh finished or is due
+static constexpr float GTodayTickSeconds = 1.0f;
+
+void FWakaTimeTodayStatus::Initialize(const FString& InExePath, const FString& InCommandLine, double InIntervalSeconds)
+{
+	ExePath = InExePath;
+	CommandLine = InCommandLine;
+	IntervalSeconds = InIntervalSeconds;
+
+	if (IntervalSeconds <= 0.0)
+	{
+		UE_LOG(LogWakaTime, Log, TEXT("Today's time in the toolbar is disabled"));
+		return;
+	}
+
+	StartRefresh();
+
+#if ENGINE_MAJOR_VERSION >= 5
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeTodayStatus::Tick), GTodayTickSeconds);
+#else // FTSTicker does not exist before UE5
+	TickerHandle = FTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateRaw(this, &FWakaTimeTodayStatus::Tick), GTodayTickSeconds);
+#endif
+}
+
+void FWakaTimeTodayStatus::Reconfigure(const FString& InExePath, const FString& InCommandLine, double InIntervalSeconds)
+{
+	if (InExePath == ExePath && InCommandLine == CommandLine && InIntervalSeconds == IntervalSeconds)
+	{
+		return;
+	}
+
+	if (IntervalSeconds > 0.0)
+	{
+		Stop();
+	}
+
+	// the old value may come from another api url, or be stale by the time a disabled toolbar is turned back on
+	CachedText = FText::GetEmpty();
+	LastSuccessTime = 0.0;
+
+	Initialize(InExePath, InCommandLine, InIntervalSeconds);
+}
+
+void FWakaTimeTodayStatus::Shutdown()
+{
+	if (IntervalSeconds <= 0.0)
+	{
+		return;
+	}
+
+	Stop();
+	LogStats();
+}
+
+void FWakaTimeTodayStatus::Stop()
+{
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#else // FTSTicker does not exist before UE5
+	FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+#endif
+
+	if (Running.IsValid())
+	{
+		// the task polls the flag, terminates the cli and returns within a few milliseconds
+		Running->bCancel = true;
+		RunningTask.Wait();
+		Running.Reset();
+	}
+}
+
+FText FWakaTimeTodayStatus::GetToolTip() const
+{
+	if (LastSuccessTime <= 0.0)
+	{
+		return FText::FromString(TEXT("Time tracked today; not known yet"));
+	}
+
+	int32 MinutesAgo = FMath::FloorToInt((FPlatformTime::Seconds() - LastSuccessTime) / 60.0);
+	return FText::FromString(FString::Printf(TEXT("Time tracked today, as of %d min ago"), MinutesAgo));
+}
+
+void FWakaTimeTodayStatus::LogStats() const
+{
+	UE_LOG(LogWakaTime, Log, TEXT("Today's time: %u refreshes, %u failed, longest took %.2f s"), NumRefreshes, NumFailed,
+	       LongestRefreshSeconds);
+}
+
+bool FWakaTimeTodayStatus::Tick(float DeltaTime)
+{
+	if (Running.IsValid())
+	{
+		if (Running->bDone)
+		{
+			FinishRefresh();
+		}
+		return true;
+	}
+
+	if (FPlatformTime::Seconds() - LastStartTime >= IntervalSeconds)
+	{
+		StartRefresh();
+	}
+	return true;
+}
+
+void FWakaTimeTodayStatus::StartRefresh()
+{
+	LastStartTime = FPlatformTime::Seconds();
+	NumRefreshes++;
+
+	TSharedRef<FRefresh, ESPMode::ThreadSafe> Refresh = MakeShared<FRefresh, ESPMode::ThreadSafe>();
+	Running = Refresh;
+
+	FString TaskExePath = ExePath;
+	FString TaskCommandLine = CommandLine;
+	RunningTask = Async(EAsyncExecution::ThreadPool, [TaskExePath, TaskCommandLine, Refresh]()
+	{
+		RunRefresh(TaskExePath, TaskCommandLine, Refresh);
+	});
+}
+
+void FWakaTimeTodayStatus::FinishRefresh()
+{
+	FString Output;
+	bool bSucceeded;
+	double Seconds;
+	{
+		FScopeLock ScopeLock(&Running->Lock);
+		Output = Running->Output;
+		bSucceeded = Running->bSucceeded;
+		Seconds = Running->Seconds;
+	}
+	Running.Reset();
+
+	LongestRefreshSeconds = FMath::Max(LongestRefreshSeconds, Seconds);
+
+	std::string Today = FWakaTimeCommandBuilder::ParseTodayOutput(TCHAR_TO_UTF8(*Output));
+	if (!bSucceeded || Today.empty())
+	{
+		// the last known value stays; it is still correct up to the time in the tooltip
+		UE_LOG(LogWakaTime, Warning, TEXT("Could not get today's time: %s"), *Output.TrimStartAndEnd());
+		NumFailed++;
+		return;
+	}
+
+	CachedText = FText::FromString(UTF8_TO_TCHAR(Today.c_str()));
+	LastSuccessTime = FPlatformTime::Seconds();
+}
+
+void FWakaTimeTodayStatus::RunRefresh(const FString& TaskExePath, const FString& TaskCommandLine,
+                                      const TSharedRef<FRefresh, ESPMode::ThreadSafe>& Refresh)
+{
+	double StartTime = FPlatformTime::Seconds();
+
+	void* ReadPipe = nullptr;
+	void* WritePipe = nullptr;
+	FPlatformProcess::CreatePipe(ReadPipe, WritePipe);
+
+	FString Output;
+	bool bSucceeded = false;
+
+	FProcHandle Process = FPlatformProcess::CreateProc(*TaskExePath, *TaskCommandLine, false, true, true, nullptr, 0, nullptr,
+	                                                   WritePipe);
+	if (Process.IsValid())
+	{
+		while (FPlatformProcess::IsProcRunning(Process))
+		{
+			Output += FPlatformProcess::ReadPipe(ReadPipe);
+
+			if (Refresh->bCancel || FPlatformTime::Seconds() - StartTime > TimeoutSeconds)
+			{
+				FPlatformProcess::TerminateProc(Process, true);
+				Output += TEXT("(terminated)");
+				break;
+			}
+			FPlatformProcess::Sleep(0.01f);
+		}
+		Output += FPlatformProcess::ReadPipe(ReadPipe);
+
+		int32 ReturnCode = -1;
+		bSucceeded = FPlatformProcess::GetProcReturnCode(Process, &ReturnCode) && ReturnCode == 0;
+		FPlatformProcess::CloseProc(Process);
+	}
+	else
+	{
+		Output = FString::Printf(TEXT("could not start %s"), *TaskExePath);
+	}
+
+	FPlatformProcess::ClosePipe(ReadPipe, WritePipe);
+
+	{
+		FScopeLock ScopeLock(&Refresh->Lock);
+		Refresh->Output = Output;
+		Refresh->bSucceeded = bSucceeded;
+		Refresh->Seconds = FPlatformTime::Seconds() - StartTime;
+	}
+	Refresh->bDone = true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleInterface.h"
+#include "Modules/ModuleManager.h"
+
+/// <summary>
+///	How soon a submitted activity is sent
+/// </summary>
+enum class EWakaTimeActivityPriority : uint8
+{
+	/// <summary> Merged with identical activities and held back while the editor is busy </summary>
+	Normal,
+
+	/// <summary> Sent as soon as it reaches the game thread, like a save </summary>
+	High
+};
+
+/// <summary>
+///	A single activity reported by another plugin. Only names and flags, so it can be copied without allocating
+/// </summary>
+struct FWakaTimeActivity
+{
+	/// <summary> What the user is doing; e.g. coding, designing, writing docs. None means coding </summary>
+	FName Category;
+
+	/// <summary> Language shown on the dashboard; e.g. Dialogue, Blueprints. None means Unreal Editor </summary>
+	FName Language;
+
+	/// <summary> Path to the file or name of the app that is being worked on </summary>
+	FName Entity;
+
+	/// <summary> file, app or domain; None means file </summary>
+	FName EntityType;
+
+	/// <summary> Whether the entity was saved </summary>
+	bool bIsWrite = false;
+
+	EWakaTimeActivityPriority Priority = EWakaTimeActivityPriority::Normal;
+};
+
+/// <summary>
+///	Stable interface for other editor plugins, e.g. custom asset editors, to report activity through WakaTime
+/// </summary>
+class IWakaTimeModule : public IModuleInterface
+{
+public:
+	/// <summary>
+	///	Returns the module; call on the game thread and keep the reference for calls from other threads
+	/// </summary>
+	static IWakaTimeModule& Get()
+	{
+		return FModuleManager::LoadModuleChecked<IWakaTimeModule>("WakaTimeForUE");
+	}
+
+	/// <summary>
+	///	Whether the module is loaded; it is not in commandlets and non-editor builds
+	/// </summary>
+	static bool IsAvailable()
+	{
+		return FModuleManager::Get().IsModuleLoaded("WakaTimeForUE");
+	}
+
+	/// <summary>
+	///	Hands the activity to the heartbeat pipeline. Safe to call from any thread; does not allocate and never blocks
+	///	for longer than a copy into a fixed queue. The activity is timestamped here and sent from the game thread
+	/// </summary>
+	/// <returns> False if the queue is full and the activity was dropped </returns>
+	virtual bool SubmitActivity(const FWakaTimeActivity& Activity) = 0;
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/Package.h"
+
+/// <summary>
+///	Aggregates high-frequency activity (e.g. dragging a slider in the details panel) into a single report per package and interval.
+///	Marking is a constant-time, allocation-free write into a small per-frame table; once per frame the table is folded into
+///	the set of packages touched this interval, and once per interval every touched package is reported.
+/// </summary>
+class FWakaTimeActivityTracker
+{
+public:
+	/// <summary>
+	///	Registers the frame ticker
+	/// </summary>
+	/// <param name="InOnActivity"> Called once per touched file and interval with the file path and the unix time of the last mark </param>
+	/// <param name="InIntervalSeconds"> How often touched packages are reported </param>
+	void Initialize(TFunction<void(const FString&, double)> InOnActivity, double InIntervalSeconds = 120.0);
+
+	/// <summary>
+	///	Unregisters the ticker and reports what was touched since the last interval
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	///	Marks the package of the object as touched this frame. Safe to call hundreds of times per frame
+	/// </summary>
+	FORCEINLINE void MarkObject(const UObject* Object)
+	{
+		if (Object)
+		{
+			MarkPackage(Object->GetOutermost());
+		}
+	}
+
+	/// <summary>
+	///	Marks the package as touched this frame. Transient and PIE packages are ignored
+	/// </summary>
+	void MarkPackage(const UPackage* Package);
+
+	/// <summary>
+	///	Folds the current frame and reports every package touched so far, regardless of the interval
+	/// </summary>
+	void Flush();
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+private:
+	bool Tick(float DeltaTime);
+
+	/// <summary>
+	///	Moves the packages marked this frame into the interval set
+	/// </summary>
+	void FoldFrame();
+
+	/// <summary> Distinct packages that can be marked within a single frame; must be a power of two </summary>
+	static constexpr int32 FrameSlots = 64;
+
+	/// <summary> Open addressing table of the packages marked this frame </summary>
+	FObjectKey FrameMarks[FrameSlots];
+	int32 NumFrameMarks = 0;
+
+	/// <summary> Consecutive marks of the same package (the common case while dragging) skip the table </summary>
+	FObjectKey LastMarked;
+
+	struct FTouchedPackage
+	{
+		FString FilePath;
+		double LastTime = 0.0;
+	};
+
+	/// <summary> Packages touched this interval, keyed by package name </summary>
+	TMap<FName, FTouchedPackage> IntervalPackages;
+
+	TFunction<void(const FString&, double)> OnActivity;
+	double IntervalSeconds = 120.0;
+	double IntervalStart = 0.0;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+
+	// Lifetime counters
+	uint64 NumMarks = 0;
+	uint64 NumFrameOverflows = 0;
+	uint64 NumReports = 0;
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+#include "HAL/CriticalSection.h"
+
+/// <summary>
+///	Keeps the shared wakatime-cli up to date. A background task compares the installed binary with the latest release
+///	at most once per interval (tracked in a manifest beside the cli, shared by every editor on the machine); a newer
+///	release is extracted side by side and swapped in with two renames, so the editor never waits for the check and
+///	a cli launched meanwhile never runs a partially written binary.
+/// </summary>
+class FWakaTimeCliUpdater
+{
+public:
+	/// <summary>
+	///	Registers the ticker; the first check happens on its first tick, never during startup
+	/// </summary>
+	/// <param name="InCliDirectory"> Directory the cli lives in, e.g. ~/.wakatime </param>
+	/// <param name="InExeName"> File name of the cli, e.g. wakatime-cli-windows-amd64.exe </param>
+	/// <param name="InArchitecture"> Architecture in the release asset names, e.g. amd64 </param>
+	/// <param name="InIntervalSeconds"> Time between two checks; 0 disables them </param>
+	void Initialize(const FString& InCliDirectory, const FString& InExeName, const FString& InArchitecture,
+	                double InIntervalSeconds);
+
+	/// <summary>
+	///	Unregisters the ticker, cancels a running check and waits for it; a download in progress is terminated
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+private:
+	/// <summary> State shared with the background task </summary>
+	struct FCheck
+	{
+		FCriticalSection Lock;
+		FString Result;
+		bool bUpdated = false;
+		bool bFailed = false;
+		std::atomic<bool> bDone{false};
+		std::atomic<bool> bCancel{false};
+	};
+
+	bool Tick(float DeltaTime);
+	void StartCheck();
+	void FinishCheck();
+
+	/// <summary>
+	///	Checks for and installs a newer release; runs on a thread pool thread
+	/// </summary>
+	static void RunCheck(const FString& TaskCliDirectory, const FString& TaskExeName, const FString& TaskArchitecture,
+	                     double TaskIntervalSeconds, const TSharedRef<FCheck, ESPMode::ThreadSafe>& Check);
+
+	/// <summary>
+	///	Runs the process and collects its output; it is terminated (and waited for) on timeout or cancellation
+	/// </summary>
+	/// <returns> True if the process exited on its own with exit code 0 </returns>
+	static bool RunProcess(const FString& ExePath, const FString& Arguments, const FCheck& Check, FString& OutOutput);
+
+	static bool RunPowershell(const FString& Command, const FCheck& Check, FString& OutOutput);
+
+	/// <summary>
+	///	Returns the version the binary prints, or an empty string if it does not run
+	/// </summary>
+	static std::string GetBinaryVersion(const FString& ExePath, const FCheck& Check);
+
+	/// <summary>
+	///	Replaces the installed binary with the new one; the old one is kept as .old until the next swap, as it may still run
+	/// </summary>
+	static bool SwapBinary(const FString& NewExePath, const FString& ExePath);
+
+	/// <summary> A download, extraction or cli call taking longer than this is terminated </summary>
+	static constexpr double ProcessTimeoutSeconds = 120.0;
+
+	FString CliDirectory;
+	FString ExeName;
+	FString Architecture;
+	double IntervalSeconds = 0.0;
+
+	TSharedPtr<FCheck, ESPMode::ThreadSafe> Running;
+	TFuture<void> RunningTask;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+
+	// Lifetime counters
+	uint32 NumChecks = 0;
+	uint32 NumUpdates = 0;
+	uint32 NumFailed = 0;
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "WakaTimeEvents.h"
+
+class IFileHandle;
+
+/// <summary>
+///	Records the editor events the module receives into a compact binary trace and replays such traces
+///	through the heartbeat pipeline, in real time or accelerated.
+///
+///	File layout: "WKTR", uint32 version, then per event: uint8 event, double seconds since the recording started,
+///	uint16 argument length, UTF-8 argument.
+/// </summary>
+class FWakaTimeEventTrace
+{
+public:
+	~FWakaTimeEventTrace();
+
+	/// <summary>
+	///	Starts writing every recorded event into the file
+	/// </summary>
+	/// <returns> False if the file could not be created </returns>
+	bool StartRecording(const FString& Path);
+
+	void StopRecording();
+
+	bool IsRecording() const { return FileHandle != nullptr; }
+
+	/// <summary>
+	///	Appends the event to the trace; does nothing while not recording
+	/// </summary>
+	/// <param name="Argument"> Whatever the heartbeat is built from, e.g. the path of the saved asset </param>
+	void Record(EWakaTimeEvent Event, const FString& Argument);
+
+	/// <summary>
+	///	Loads the trace and starts feeding its events to OnEvent from the core ticker
+	/// </summary>
+	/// <param name="Speed"> 1 replays in real time, 60 replays a minute per second; 0 replays as fast as possible </param>
+	/// <param name="InOnEvent">
+	///	Receives the events with their unix time, on the game thread. The times keep the recorded spacing whatever the speed,
+	///	shifted so the last event of the trace falls on the moment the replay started
+	/// </param>
+	/// <param name="InOnFinished"> Called once the last event was replayed </param>
+	bool StartReplay(const FString& Path, double Speed, TFunction<void(EWakaTimeEvent, const FString&, double)> InOnEvent,
+	                 TFunction<void()> InOnFinished);
+
+	void StopReplay();
+
+	bool IsReplaying() const { return ReplayRecords.Num() > 0; }
+
+private:
+	struct FTraceRecord
+	{
+		EWakaTimeEvent Event;
+		double Time;
+		FString Argument;
+	};
+
+	bool TickReplay(float DeltaTime);
+	void FlushBuffer();
+
+	static constexpr uint32 Magic = 'W' | ('K' << 8) | ('T' << 16) | ('R' << 24);
+	static constexpr uint32 Version = 1;
+
+	/// <summary> Events replayed per frame when replaying as fast as possible </summary>
+	static constexpr int32 MaxEventsPerFrameUnthrottled = 64;
+
+	// Recording
+	IFileHandle* FileHandle = nullptr;
+	TArray<uint8> WriteBuffer;
+	double RecordingStartTime = 0.0;
+	uint32 NumRecorded = 0;
+
+	// Replay
+	TArray<FTraceRecord> ReplayRecords;
+	int32 ReplayIndex = 0;
+	double ReplaySpeed = 1.0;
+	double ReplayStartTime = 0.0;
+
+	/// <summary> Unix time the start of the recording is mapped to </summary>
+	double ReplayClockOrigin = 0.0;
+	TFunction<void(EWakaTimeEvent, const FString&, double)> OnEvent;
+	TFunction<void()> OnFinished;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+};
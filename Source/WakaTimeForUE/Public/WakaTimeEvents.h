@@ -0,0 +1,47 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/// <summary>
+///	Every editor event the plugin reacts to. The values are stored in trace files, so new events are only appended
+/// </summary>
+enum class EWakaTimeEvent : uint8
+{
+	ActorsDropped,
+	ActorsDuplicated,
+	ActorsDeleted,
+	LevelAddedToWorld,
+	WorldSaved,
+	PieStarted,
+	PieEnded,
+	BlueprintCompiled,
+	AssetOpened,
+	AssetClosed,
+	PropertiesEdited,
+	TransactionCommitted,
+
+	Count
+};
+
+/// <summary>
+///	Returns a readable name of the event, e.g. for logs
+/// </summary>
+inline const TCHAR* GetWakaTimeEventName(EWakaTimeEvent Event)
+{
+	switch (Event)
+	{
+	case EWakaTimeEvent::ActorsDropped: return TEXT("ActorsDropped");
+	case EWakaTimeEvent::ActorsDuplicated: return TEXT("ActorsDuplicated");
+	case EWakaTimeEvent::ActorsDeleted: return TEXT("ActorsDeleted");
+	case EWakaTimeEvent::LevelAddedToWorld: return TEXT("LevelAddedToWorld");
+	case EWakaTimeEvent::WorldSaved: return TEXT("WorldSaved");
+	case EWakaTimeEvent::PieStarted: return TEXT("PieStarted");
+	case EWakaTimeEvent::PieEnded: return TEXT("PieEnded");
+	case EWakaTimeEvent::BlueprintCompiled: return TEXT("BlueprintCompiled");
+	case EWakaTimeEvent::AssetOpened: return TEXT("AssetOpened");
+	case EWakaTimeEvent::AssetClosed: return TEXT("AssetClosed");
+	case EWakaTimeEvent::PropertiesEdited: return TEXT("PropertiesEdited");
+	case EWakaTimeEvent::TransactionCommitted: return TEXT("TransactionCommitted");
+	default: return TEXT("Unknown");
+	}
+}
@@ -1,13 +1,41 @@
 #pragma once
 
 #include <string>
-#include <map>
 #include <Runtime/SlateCore/Public/Styling/SlateStyle.h>
 #include "EditorStyleSet.h"
+#include "WakaTimeProcessSupervisor.h"
+#include "WakaTimeHeartbeatScheduler.h"
+#include "WakaTimeRelayClient.h"
+#include "WakaTimeEventTrace.h"
+#include "WakaTimeActivityTracker.h"
+#include "WakaTimeSubmissionQueue.h"
+#include "WakaTimeTodayStatus.h"
+#include "WakaTimeCliUpdater.h"
+#include "WakaTimeCommand.h"
+#include "WakaTimeSessionPacer.h"
+#include "WakaTimeEventPolicy.h"
+#include "WakaTimeConfig.h"
+#include "IWakaTimeModule.h"
+#include "Misc/ITransaction.h"
+
+class SEditableTextBox;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogWakaTime, Log, All);
 
-class FWakaTimeForUEModule : public IModuleInterface
+/// <summary>
+///	What caused a level to be added to the world; only user additions produce heartbeats
+/// </summary>
+enum class EWakaTimeLevelSource : uint8
+{
+	User,
+	Streaming,
+	WorldPartition,
+	PlayInEditor,
+
+	Count
+};
+
+class FWakaTimeForUEModule : public IWakaTimeModule
 {
 public:
 	// Module methods
@@ -23,6 +51,11 @@ public:
 	/// </summary>
 	virtual void ShutdownModule() override;
 
+	/// <summary>
+	///	Queues an activity reported by another plugin; any thread
+	/// </summary>
+	virtual bool SubmitActivity(const FWakaTimeActivity& Activity) override;
+
 
 	// Initialization methods
 
@@ -39,11 +72,17 @@ public:
 	void HandleStartupApiCheck(std::string ConfigFilePath);
 
 	/// <summary>
-	///	Checks whether the wakatime config file exists and includes the api_key
+	///	Reads the [settings] section of the wakatime config file into the global variables
 	/// </summary>
 	/// <param name="ConfigFilePath"> Path to the config file directory</param>
 	void ReadConfig(std::string ConfigFilePath, bool& bFoundApiKey, bool& bFoundApiUrl);
 
+	/// <summary>
+	///	Hands the current today_interval and cli arguments to the toolbar's today status; called on startup and
+	///	whenever the config is read again
+	/// </summary>
+	void ApplyTodaySettings();
+
 	/// <summary>
 	///	Checks if Wakatime exists, if not, downloads it using Powershell
 	/// </summary>
@@ -55,6 +94,16 @@ public:
 	/// </summary>
 	std::string GetProjectName();
 
+	/// <summary>
+	///	Registers the WakaTime.* console commands (trace recording and replay, stats)
+	/// </summary>
+	void RegisterConsoleCommands();
+
+	/// <summary>
+	///	Writes the level addition counters and those of the tracker, the scheduler and the process supervisor into the log
+	/// </summary>
+	void LogStats();
+
 
 	// UI methods
 
@@ -76,33 +125,106 @@ public:
 	void OpenSettingsWindowFromUI();
 	
 	/// <summary>
-	///	Opens the Slate window
+	///	Builds and opens the Slate window, or brings it to front if it is already open
 	/// </summary>
 	void OpenSettingsWindow();
 
+	/// <summary>
+	///	Releases the widgets of the settings window
+	/// </summary>
+	void OnSettingsWindowClosed(const TSharedRef<SWindow>& Window);
+
 	/// <summary>
 	///	Called when user clicks "Save" within the slate window.
 	///	Saves the entered api key into the wakatime.cfg file
 	/// </summary>
 	FReply SaveData();
 
-	void UpdateIniEntry(bool& bIsDirty, std::map<std::string, std::string>& Data, std::string Key, std::string Value);
-
 
 	// Lifecycle methods
 
 
 	/// <summary>
-	///	Sends heartbeat to wakatime
+	///	Queues a heartbeat for wakatime; it is sent once the editor is not busy
 	/// </summary>
 	/// <param name="bFileSave"> whether to attach the file that is being worked on </param>
 	/// <param name="FilePath"> path to the current file that is being edited </param>
 	/// <param name="Activity"> activity being performed by the user while sending the heartbeat; e.g. coding, designing, debugging, etc. </param>
-	void SendHeartbeat(bool bFileSave, std::string Activity, std::string EntityType, FString Entity, std::string Language);
+	/// <param name="Time"> unix time of the activity; 0 means now </param>
+	/// <param name="bUrgent"> whether to skip the scheduler; saves always do </param>
+	void SendHeartbeat(bool bFileSave, std::string Activity, std::string EntityType, FString Entity, std::string Language,
+	                   double Time = 0.0, bool bUrgent = false);
+
+	/// <summary>
+	///	Sends the heartbeat to the relay, or builds the cli command for it and hands it to the process supervisor
+	/// </summary>
+	void LaunchHeartbeat(const FWakaTimeHeartbeat& Heartbeat);
+
+	/// <summary>
+	///	Sends the heartbeats to the relay; what it does not take goes out in a single cli call
+	/// </summary>
+	void LaunchHeartbeats(const std::vector<FWakaTimeHeartbeat>& Heartbeats);
+
+	/// <summary>
+	///	Hands a single cli call for the heartbeats to the process supervisor
+	/// </summary>
+	void LaunchHeartbeatProcess(const std::vector<FWakaTimeHeartbeat>& Heartbeats);
+
+	/// <summary>
+	///	Returns the cli arguments shared by every call
+	/// </summary>
+	static FWakaTimeCliSettings GetCliSettings();
+
+	/// <summary>
+	///	Builds a single cli call for the heartbeats; the first one goes on the command line, the rest as --extra-heartbeats
+	/// </summary>
+	/// <param name="Heartbeats"> At least one heartbeat </param>
+	FWakaTimeProcessRequest BuildHeartbeatRequest(const std::vector<FWakaTimeHeartbeat>& Heartbeats);
+
+	/// <summary>
+	///	Sends whatever is still waiting in one cli call, waiting for it no longer than the shutdown budget;
+	///	what does not make it is written into the spool file for the next launch
+	/// </summary>
+	void FlushHeartbeatsOnShutdown();
+
+	/// <summary>
+	///	Sends the heartbeats the last session could not send before the editor closed
+	/// </summary>
+	void SendSpooledHeartbeats();
+
+	/// <summary>
+	///	Returns the path of the file heartbeats are kept in between sessions
+	/// </summary>
+	static FString GetHeartbeatSpoolPath();
 
 
 	// Event methods
 
+	/// <summary>
+	///	Records the event into the trace (if recording) and turns it into a heartbeat.
+	///	Every delegate ends up here, so a replayed trace goes through the same pipeline as live events
+	/// </summary>
+	/// <param name="Argument"> Event specific data the heartbeat is built from, e.g. the path of a compiled blueprint </param>
+	/// <param name="Time"> unix time of the activity, for events that are reported later than they happened; 0 means now </param>
+	void HandleEditorEvent(EWakaTimeEvent Event, const FString& Argument, double Time = 0.0);
+
+	/// <summary>
+	///	Sends the heartbeat of an event if its policy lets it through, with the category and priority of the policy
+	/// </summary>
+	void SendEventHeartbeat(EWakaTimeEvent Event, double Time, bool bFileSave, std::string EntityType, FString Entity,
+	                        std::string Language);
+
+	/// <summary>
+	///	Checks the policy of the event: enabled, minimum interval and sample rate. An array access for events that always pass
+	/// </summary>
+	/// <param name="Time"> unix time of the event; the minimum interval is measured with it, not with the wall clock </param>
+	bool PassesEventPolicy(EWakaTimeEvent Event, double Time);
+
+	/// <summary>
+	///	Compiles the [unreal] section of the config into the per event policies, on top of the built-in defaults
+	/// </summary>
+	void LoadEventPolicies(const FWakaTimeConfig& Config);
+
 	/// <summary>
 	///	Event called when an actor is dropped into the scene
 	/// </summary>
@@ -123,6 +245,12 @@ public:
 	/// </summary>
 	void OnAddLevelToWorld(ULevel* Level);
 
+	/// <summary>
+	///	Tells levels the user added apart from levels streamed in by the editor, World Partition or a play session,
+	///	going by the streaming level that loaded it rather than by the world it was added to
+	/// </summary>
+	static EWakaTimeLevelSource ClassifyLevelAddition(const ULevel* Level);
+
 	/// <summary>
 	///	Event called when the world is saved (Generally CTRL + S while in the viewport window)
 	/// </summary>
@@ -142,11 +270,31 @@ public:
 	/// </summary>
 	void OnPrePieEnded(bool bIsSimulating);
 
+	/// <summary>
+	///	Ends the play session, if one is running, and sends the heartbeats covering the rest of it
+	/// </summary>
+	void StopPieSession();
+
+	/// <summary>
+	///	Sends one debugging heartbeat per time, all in one batch
+	/// </summary>
+	void SendPieSessionHeartbeats(const std::vector<double>& Times);
+
 	/// <summary>
 	///	Event called prior to blueprint compiling
 	/// </summary>
 	void OnBlueprintPreCompile(UBlueprint* Blueprint);
 	
+	/// <summary>
+	///	Event called whenever a property of any object changes, e.g. for every step of a slider drag in the details panel
+	/// </summary>
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+
+	/// <summary>
+	///	Event called when an undo transaction changes state; a finalized transaction (or undo/redo) marks every package it touched
+	/// </summary>
+	void OnTransactionStateChanged(const FTransactionContext& TransactionContext, ETransactionStateEventType TransactionState);
+
 	/// <summary>
 	///	Event called when editor window is initialized
 	/// </summary>
@@ -165,6 +313,35 @@ public:
 #endif
 
 	TSharedPtr<FUICommandList> PluginCommands;
+	/// <summary> Only exist while the settings window is open </summary>
+	TSharedPtr<SWindow> SettingsWindow;
+	TSharedPtr<SEditableTextBox> ApiKeyTextBox;
+	TSharedPtr<SEditableTextBox> ApiUrlTextBox;
+	FWakaTimeProcessSupervisor ProcessSupervisor;
+	FWakaTimeHeartbeatScheduler HeartbeatScheduler;
+	FWakaTimeRelayClient RelayClient;
+	FWakaTimeEventTrace EventTrace;
+	FWakaTimeActivityTracker ActivityTracker;
+	FWakaTimeSubmissionQueue SubmissionQueue;
+	FWakaTimeTodayStatus TodayStatus;
+	FWakaTimeCliUpdater CliUpdater;
+	/// <summary> Covers play sessions with a heartbeat every 2 minutes, the rate of IDE plugins, as nothing else reports activity while playing </summary>
+	FWakaTimeSessionPacer PieSession;
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle PieSessionTickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle PieSessionTickerHandle;
+#endif
+	uint32 NumPieSessionHeartbeats = 0;
+	/// <summary> Indexed by EWakaTimeEvent </summary>
+	FWakaTimeEventPolicy EventPolicies[static_cast<int32>(EWakaTimeEvent::Count)];
+	double LastEventHeartbeatTimes[static_cast<int32>(EWakaTimeEvent::Count)] = {};
+	uint32 NumEventsFilteredByPolicy = 0;
+	TArray<IConsoleObject*> ConsoleCommands;
+	/// <summary> Set once the undo buffer is hooked; the per-action actor delegates then only feed the trace </summary>
+	bool bTrackTransactions = false;
+	/// <summary> Levels added to the world, per EWakaTimeLevelSource </summary>
+	uint64 NumLevelAdditions[static_cast<int32>(EWakaTimeLevelSource::Count)] = {};
 #if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 4 // RedTheKitsune(OnAssetClosedInEditor is not available in <UE5.4, so blueprint name tracking will not work properly)
 	TArray<TSharedRef<FString>> OpenedBPs;
 #endif
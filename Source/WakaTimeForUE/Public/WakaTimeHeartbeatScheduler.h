@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+
+#include "Containers/Ticker.h"
+#include "WakaTimeHeartbeat.h"
+#include "WakaTimeDispatchQueue.h"
+
+/// <summary>
+///	Holds back heartbeats while the editor is busy (PIE or frames over budget), so spawning the cli
+///	does not add a hitch to frames that matter. Heartbeats are released one per frame once the editor is idle
+///	or under budget, and never wait longer than the maximum delay. Saves are released first, on the next frame.
+///	Nothing is released while the sink is saturated; the queue has a fixed size, so under pressure informational
+///	heartbeats are shed oldest first, while saves that do not fit are handed to the overflow callback.
+/// </summary>
+class FWakaTimeHeartbeatScheduler
+{
+public:
+	/// <summary>
+	///	Registers the frame ticker
+	/// </summary>
+	/// <param name="InOnDispatch"> Called on the game thread for every heartbeat that is let through </param>
+	/// <param name="InOnWriteOverflow"> Called for saves that do not fit into the queue; they must not be lost </param>
+	/// <param name="InIsSinkSaturated"> Whether whatever OnDispatch feeds cannot take more right now </param>
+	/// <param name="InFrameBudgetSeconds"> Smoothed frame time under which the editor is considered not busy </param>
+	/// <param name="InMaxDelaySeconds"> Longest time a heartbeat can be held back </param>
+	void Initialize(TFunction<void(const FWakaTimeHeartbeat&)> InOnDispatch,
+	                TFunction<void(const FWakaTimeHeartbeat&)> InOnWriteOverflow, TFunction<bool()> InIsSinkSaturated,
+	                double InFrameBudgetSeconds = 1.0 / 30.0, double InMaxDelaySeconds = 30.0);
+
+	/// <summary>
+	///	Unregisters the ticker and dispatches whatever is still waiting
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	///	Queues a heartbeat. Urgent heartbeats are dispatched right away, saves wait in the write lane for the next frame,
+	///	the rest are merged with an identical waiting heartbeat or held until the editor is not busy
+	/// </summary>
+	void Enqueue(const FWakaTimeHeartbeat& Heartbeat, bool bUrgent);
+
+	/// <summary>
+	///	Dispatches every waiting heartbeat regardless of the editor state
+	/// </summary>
+	void DispatchAll();
+
+	/// <summary>
+	///	Removes every waiting heartbeat without dispatching it, e.g. to send them all in one batch
+	/// </summary>
+	std::vector<FWakaTimeHeartbeat> TakePending();
+
+	int32 GetPendingCount() const { return static_cast<int32>(Queue.Num()); }
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+	/// <summary>
+	///	Returns the current unix time in seconds
+	/// </summary>
+	static double Now();
+
+private:
+	bool Tick(float DeltaTime);
+
+	/// <summary>
+	///	Whether spawning a process now would compete with a frame that matters
+	/// </summary>
+	bool IsEditorBusy() const;
+
+	/// <summary> User input more recent than this means the editor is not idle </summary>
+	static constexpr double IdleAfterSeconds = 2.0;
+
+	TFunction<void(const FWakaTimeHeartbeat&)> OnDispatch;
+	TFunction<void(const FWakaTimeHeartbeat&)> OnWriteOverflow;
+	TFunction<bool()> IsSinkSaturated;
+	double FrameBudgetSeconds = 1.0 / 30.0;
+	double SmoothedFrameSeconds = 0.0;
+
+	/// <summary> Lanes, merging and the release decision live in the engine independent core </summary>
+	FWakaTimeDispatchQueue Queue;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+
+	// Lifetime counters, on top of the ones of the queue
+	uint32 NumUrgent = 0;
+	uint32 NumSaturatedFrames = 0;
+};
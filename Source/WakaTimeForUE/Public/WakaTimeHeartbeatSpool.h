@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "WakaTimeHeartbeat.h"
+
+/// <summary>
+///	Keeps heartbeats that could not be sent before the editor closed in a file (one JSON object per line)
+///	until the next launch.
+/// </summary>
+class FWakaTimeHeartbeatSpool
+{
+public:
+	/// <summary>
+	///	Appends the heartbeats to the spool file
+	/// </summary>
+	/// <returns> False if the file could not be written </returns>
+	static bool Append(const FString& Path, const std::vector<FWakaTimeHeartbeat>& Heartbeats);
+
+	/// <summary>
+	///	Reads every heartbeat from the spool file and deletes it; lines that cannot be parsed are skipped
+	/// </summary>
+	static std::vector<FWakaTimeHeartbeat> Take(const FString& Path);
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+
+#include "Containers/Ticker.h"
+#include "WakaTimeHeartbeatScheduler.h"
+
+/// <summary>
+///	A single process launch request handed to the supervisor
+/// </summary>
+struct FWakaTimeProcessRequest
+{
+	/// <summary> Path to the exe </summary>
+	std::string ExeToRun;
+
+	/// <summary> Arguments passed to the exe (without the exe itself) </summary>
+	std::string CommandToRun;
+
+	/// <summary> Path to the directory to start the process in; empty uses the editor's directory </summary>
+	std::string Directory;
+
+	/// <summary> Short description used when reporting slow or killed processes </summary>
+	std::string Label;
+
+	/// <summary> Written to the standard input of the process, then the input is closed; empty leaves the input alone </summary>
+	std::string StdinData;
+
+	/// <summary> Heartbeats the process sends, so a request that never started can still be sent some other way </summary>
+	std::vector<FWakaTimeHeartbeat> Heartbeats;
+};
+
+/// <summary>
+///	Owns every wakatime-cli process launched by the plugin.
+///	Processes are put into a job object, the number of processes running at once is capped,
+///	each process gets a deadline after which it is terminated and exit codes are reaped on a ticker
+///	instead of blocking the game thread.
+/// </summary>
+class FWakaTimeProcessSupervisor
+{
+public:
+	/// <summary>
+	///	Creates the job object and registers the reaping ticker
+	/// </summary>
+	/// <param name="InOnWriteOverflow"> Receives the heartbeats of saves that do not fit into the full queue; they must not be lost </param>
+	/// <param name="InMaxInFlight"> How many processes may run at the same time </param>
+	/// <param name="InTimeoutSeconds"> How long a process may run before it is terminated </param>
+	/// <param name="InSlowSeconds"> Processes running longer than this are reported as slow </param>
+	void Initialize(TFunction<void(const std::vector<FWakaTimeHeartbeat>&)> InOnWriteOverflow, int32 InMaxInFlight = 4,
+	                double InTimeoutSeconds = 60.0, double InSlowSeconds = 10.0);
+
+	/// <summary>
+	///	Unregisters the ticker and releases all handles. Processes still running are left alive so they can finish sending
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	///	Starts the process right away if there is a free slot, otherwise queues it
+	/// </summary>
+	/// <returns> False if the request had to be dropped </returns>
+	bool Launch(const FWakaTimeProcessRequest& Request);
+
+	/// <summary>
+	///	Starts the process right away, regardless of the cap, and blocks until it exits or the timeout passes.
+	///	A process over the timeout is terminated. Meant for shutdown, where nothing can be reaped later
+	/// </summary>
+	/// <param name="OutExitCode"> Exit code of the process, if it exited in time </param>
+	/// <returns> False if the process could not be started or was terminated </returns>
+	bool LaunchAndWait(const FWakaTimeProcessRequest& Request, double InTimeoutSeconds, uint32& OutExitCode);
+
+	/// <summary>
+	///	Removes every request still waiting for a free slot without starting it
+	/// </summary>
+	std::vector<FWakaTimeProcessRequest> TakeQueued();
+
+	/// <summary>
+	///	Reaps finished processes, terminates the ones over the deadline and starts queued ones
+	/// </summary>
+	void Reap();
+
+	int32 GetInFlightCount() const { return static_cast<int32>(InFlight.size()); }
+	int32 GetQueuedCount() const { return static_cast<int32>(Queued.size()); }
+
+	/// <summary>
+	///	Whether wakatime-cli took care of its heartbeats: sent them (0), or kept them in its offline queue (102, 112)
+	/// </summary>
+	static bool IsHeartbeatExitSafe(uint32 ExitCode);
+
+	/// <summary>
+	///	Whether every slot is taken, so another request would have to wait in the queue
+	/// </summary>
+	bool IsSaturated() const { return GetInFlightCount() + GetQueuedCount() >= MaxInFlight; }
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+private:
+	struct FTrackedProcess
+	{
+		void* ProcessHandle = nullptr;
+		uint32 ProcessId = 0;
+		double StartTime = 0.0;
+		bool bReportedSlow = false;
+		std::string Label;
+	};
+
+	bool StartProcess(const FWakaTimeProcessRequest& Request);
+	static bool ContainsWrite(const FWakaTimeProcessRequest& Request);
+	void CloseTrackedProcess(FTrackedProcess& Process);
+	bool Tick(float DeltaTime);
+
+	/// <summary>
+	///	Upper bound of requests waiting for a free slot; past it the oldest one without a save is dropped,
+	///	or the new request is handed to OnWriteOverflow if every queued one holds a save
+	/// </summary>
+	static constexpr int32 MaxQueued = 64;
+
+	TFunction<void(const std::vector<FWakaTimeHeartbeat>&)> OnWriteOverflow;
+
+	void* JobHandle = nullptr;
+	int32 MaxInFlight = 4;
+	double TimeoutSeconds = 60.0;
+	double SlowSeconds = 10.0;
+
+	std::vector<FTrackedProcess> InFlight;
+	std::deque<FWakaTimeProcessRequest> Queued;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+
+	// Lifetime counters
+	uint32 NumLaunched = 0;
+	uint32 NumFailedToStart = 0;
+	uint32 NumQueuedOffline = 0;
+	uint32 NumNonZeroExit = 0;
+	uint32 NumSlow = 0;
+	uint32 NumKilled = 0;
+	uint32 NumDropped = 0;
+	uint32 NumOverflowed = 0;
+	uint32 PeakInFlight = 0;
+};
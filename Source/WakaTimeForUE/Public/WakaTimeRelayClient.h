@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Containers/Ticker.h"
+
+class FSocket;
+class FInternetAddr;
+class FResolveInfo;
+struct FWakaTimeHeartbeat;
+
+/// <summary>
+///	Keeps a persistent connection to a WakaTimeRelay and streams heartbeats to it instead of spawning the cli.
+///	Enabled by "relay_url = host[:port]" in .wakatime.cfg, "relay_secret" has to match the secret the relay was started with.
+///	While the relay cannot be reached the heartbeats are refused, so the caller can fall back to the cli.
+/// </summary>
+class FWakaTimeRelayClient
+{
+public:
+	/// <summary>
+	///	Starts resolving the relay address and registers the ticker that connects and sends
+	/// </summary>
+	/// <param name="RelayUrl"> host[:port] of the relay </param>
+	/// <param name="Secret"> Shared relay secret the connection is authenticated with </param>
+	/// <param name="ApiKey"> Api key the relay forwards the heartbeats with; it is only sent sealed with the secret </param>
+	/// <param name="Plugin"> Plugin identifier, e.g. unreal-wakatime/1.2.6 </param>
+	void Initialize(const std::string& RelayUrl, const std::string& Secret, const std::string& ApiKey,
+	                const std::string& Plugin);
+
+	/// <summary>
+	///	Sends what can be sent without waiting and closes the connection
+	/// </summary>
+	/// <returns> The heartbeats the relay did not receive; the caller has to keep them for the next launch </returns>
+	std::vector<FWakaTimeHeartbeat> Shutdown();
+
+	bool IsEnabled() const { return bEnabled; }
+	bool IsConnected() const { return bConnected; }
+
+	/// <summary>
+	///	Queues the heartbeat for the relay
+	/// </summary>
+	/// <returns> False if the relay is not connected or too far behind; the heartbeat has to be sent another way </returns>
+	bool Send(const FWakaTimeHeartbeat& Heartbeat, const std::string& Project);
+
+private:
+	bool Tick(float DeltaTime);
+	void Connect();
+	void Disconnect();
+	void Flush();
+
+	/// <summary>
+	///	Answers the challenge of the relay and waits for it to accept the hello
+	/// </summary>
+	/// <returns> False if the relay closed the connection or sent something unexpected </returns>
+	bool ReadHandshake();
+
+	/// <summary>
+	///	Turns a heartbeat record back into the heartbeat it was built from
+	/// </summary>
+	static bool ParseHeartbeatRecord(const std::string& Record, FWakaTimeHeartbeat& OutHeartbeat);
+
+	/// <summary> Unsent bytes above this mean the relay is not keeping up </summary>
+	static constexpr size_t MaxPendingBytes = 256 * 1024;
+
+	static constexpr double MinReconnectSeconds = 1.0;
+	static constexpr double MaxReconnectSeconds = 60.0;
+
+	bool bEnabled = false;
+	bool bConnected = false;
+
+	/// <summary> The socket is connected, but the relay has not accepted the hello yet </summary>
+	bool bHandshaking = false;
+
+	std::string Host;
+	int32 Port = 0;
+	std::string Secret;
+	std::string ApiKey;
+	std::string Plugin;
+	std::string Machine;
+
+	/// <summary> Received bytes of an incomplete handshake record </summary>
+	std::string ReadBuffer;
+
+	FSocket* Socket = nullptr;
+	TSharedPtr<FInternetAddr> Address;
+	FResolveInfo* PendingResolve = nullptr;
+
+	/// <summary> Records waiting to be sent; starts at the beginning of the first record the relay has not fully received </summary>
+	std::string Pending;
+
+	/// <summary> Bytes at the start of Pending already handed to the socket </summary>
+	size_t SentBytes = 0;
+
+	double ReconnectDelay = MinReconnectSeconds;
+	double NextConnectTime = 0.0;
+	double ConnectStartTime = 0.0;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+};
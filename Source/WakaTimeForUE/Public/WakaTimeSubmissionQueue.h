@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "HAL/CriticalSection.h"
+#include "IWakaTimeModule.h"
+
+/// <summary>
+///	Fixed size ring of activities submitted through IWakaTimeModule, from any thread.
+///	Submitting copies the activity into the ring under a lock; the ring is drained on the game thread once per frame.
+/// </summary>
+class FWakaTimeSubmissionQueue
+{
+public:
+	/// <summary>
+	///	Registers the frame ticker
+	/// </summary>
+	/// <param name="InOnActivity"> Called on the game thread for every submitted activity, with the unix time it was submitted at </param>
+	void Initialize(TFunction<void(const FWakaTimeActivity&, double)> InOnActivity);
+
+	/// <summary>
+	///	Unregisters the ticker and passes on whatever is still queued
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	///	Copies the activity into the ring; any thread
+	/// </summary>
+	/// <returns> False if the ring is full </returns>
+	bool Submit(const FWakaTimeActivity& Activity);
+
+	/// <summary>
+	///	Passes every queued activity on; game thread only
+	/// </summary>
+	void Drain();
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+private:
+	bool Tick(float DeltaTime);
+
+	struct FSubmittedActivity
+	{
+		FWakaTimeActivity Activity;
+		double Time = 0.0;
+	};
+
+	/// <summary> Activities that can wait for the next frame; must be a power of two </summary>
+	static constexpr int32 Capacity = 256;
+
+	FCriticalSection Lock;
+	FSubmittedActivity Ring[Capacity];
+	int32 Head = 0;
+	int32 Count = 0;
+
+	TFunction<void(const FWakaTimeActivity&, double)> OnActivity;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+
+	// Lifetime counters, written under the lock
+	uint64 NumSubmitted = 0;
+	uint64 NumDropped = 0;
+	int32 PeakCount = 0;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+#include "HAL/CriticalSection.h"
+
+/// <summary>
+///	Caches the time tracked today for the toolbar. A background task runs "wakatime-cli --today" on an interval and
+///	the result is picked up on the game thread, so drawing the toolbar (in any number of editor windows) only reads
+///	the cached text and never waits for the cli.
+/// </summary>
+class FWakaTimeTodayStatus
+{
+public:
+	/// <summary>
+	///	Registers the refresh ticker; the first refresh starts right away
+	/// </summary>
+	/// <param name="InExePath"> Path to the wakatime-cli exe </param>
+	/// <param name="InCommandLine"> Arguments of the --today call </param>
+	/// <param name="InIntervalSeconds"> How often the value is refreshed; 0 disables it </param>
+	void Initialize(const FString& InExePath, const FString& InCommandLine, double InIntervalSeconds);
+
+	/// <summary>
+	///	Applies changed settings, e.g. after the config was reloaded; the cached value is dropped and refreshed
+	///	right away with the new arguments. Does nothing when nothing changed
+	/// </summary>
+	void Reconfigure(const FString& InExePath, const FString& InCommandLine, double InIntervalSeconds);
+
+	/// <summary>
+	///	Unregisters the ticker and stops a running refresh
+	/// </summary>
+	void Shutdown();
+
+	/// <summary>
+	///	Returns the cached value, e.g. "3 hrs 12 mins"; empty until the first refresh finished. Never blocks
+	/// </summary>
+	const FText& GetText() const { return CachedText; }
+
+	/// <summary>
+	///	Returns a tooltip describing how old the cached value is
+	/// </summary>
+	FText GetToolTip() const;
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+private:
+	/// <summary> State shared with the background task, which may outlive a refresh that was given up </summary>
+	struct FRefresh
+	{
+		FCriticalSection Lock;
+		FString Output;
+		bool bSucceeded = false;
+		double Seconds = 0.0;
+		std::atomic<bool> bDone{false};
+		std::atomic<bool> bCancel{false};
+	};
+
+	bool Tick(float DeltaTime);
+
+	/// <summary>
+	///	Unregisters the ticker and cancels a running refresh, waiting for its task
+	/// </summary>
+	void Stop();
+
+	void StartRefresh();
+	void FinishRefresh();
+
+	/// <summary>
+	///	Runs the cli and collects its output; runs on a thread pool thread
+	/// </summary>
+	static void RunRefresh(const FString& TaskExePath, const FString& TaskCommandLine, const TSharedRef<FRefresh, ESPMode::ThreadSafe>& Refresh);
+
+	/// <summary> A cli call that takes longer than this is terminated </summary>
+	static constexpr double TimeoutSeconds = 20.0;
+
+	FString ExePath;
+	FString CommandLine;
+	double IntervalSeconds = 0.0;
+	double LastStartTime = 0.0;
+	double LastSuccessTime = 0.0;
+
+	FText CachedText;
+	TSharedPtr<FRefresh, ESPMode::ThreadSafe> Running;
+	TFuture<void> RunningTask;
+
+#if ENGINE_MAJOR_VERSION >= 5
+	FTSTicker::FDelegateHandle TickerHandle;
+#else // FTSTicker does not exist before UE5
+	FDelegateHandle TickerHandle;
+#endif
+
+	// Lifetime counters
+	uint32 NumRefreshes = 0;
+	uint32 NumFailed = 0;
+	double LongestRefreshSeconds = 0.0;
+};
@@ -1,3 +1,4 @@
+using System.IO;
 using UnrealBuildTool;
 
 public class WakaTimeForUE : ModuleRules
@@ -15,6 +16,8 @@ public class WakaTimeForUE : ModuleRules
 		
 		PrivateIncludePaths.AddRange(
 			new string[] {
+				// the relay protocol is header only and shared with the WakaTimeRelay program
+				Path.Combine(ModuleDirectory, "..", "WakaTimeRelay", "Public")
 				// ... add other private include paths required here ...
 			}
 			);
@@ -23,7 +26,9 @@ public class WakaTimeForUE : ModuleRules
 		PublicDependencyModuleNames.AddRange(
 			new string[]
 			{
-				"Core"
+				"Core",
+				// the heartbeat model and everything else that does not need the engine
+				"WakaTimeCore"
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -40,7 +45,9 @@ public class WakaTimeForUE : ModuleRules
 				"EditorStyle",
 				"EngineSettings",
 				"UnrealEd",
-				"Projects"
+				"Projects",
+				"Sockets",
+				"Networking"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
@@ -0,0 +1,94 @@
+#include "WakaTimeMockUpstream.h"
+
+#include "WakaTimeRelayServer.h"
+#include "HttpServerModule.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "Dom/JsonValue.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+bool FWakaTimeMockUpstream::Start(int32 InPort, int32 InFailEvery)
+{
+	Port = InPort;
+	FailEvery = InFailEvery;
+
+	TSharedPtr<IHttpRouter> Router = FHttpServerModule::Get().GetHttpRouter(Port);
+	if (!Router.IsValid())
+	{
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Mock upstream could not open port %d"), Port);
+		return false;
+	}
+
+	auto Handler = [this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+	{
+		NumRequests++;
+
+		if (FailEvery > 0 && NumRequests % FailEvery == 0)
+		{
+			UE_LOG(LogWakaTimeRelay, Display, TEXT("Mock upstream: failing request %llu on purpose"), NumRequests);
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::ServiceUnavail));
+			return true;
+		}
+
+		FUTF8ToTCHAR Body(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()), Request.Body.Num());
+		TArray<TSharedPtr<FJsonValue>> Heartbeats;
+		TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(FString(Body.Length(), Body.Get()));
+		if (!FJsonSerializer::Deserialize(Reader, Heartbeats))
+		{
+			OnComplete(FHttpServerResponse::Error(EHttpServerResponseCodes::BadRequest));
+			return true;
+		}
+
+		NumHeartbeats += Heartbeats.Num();
+		UE_LOG(LogWakaTimeRelay, Display, TEXT("Mock upstream: request %llu with %d heartbeats (%llu total)"),
+		       NumRequests, Heartbeats.Num(), NumHeartbeats);
+
+		// the real api answers with one result per heartbeat
+		FString Responses;
+		for (int32 Index = 0; Index < Heartbeats.Num(); Index++)
+		{
+			Responses += (Index == 0 ? TEXT("") : TEXT(",")) + FString(TEXT("[{},201]"));
+		}
+		TUniquePtr<FHttpServerResponse> Response =
+			FHttpServerResponse::Create(TEXT("{\"responses\":[") + Responses + TEXT("]}"), TEXT("application/json"));
+		Response->Code = EHttpServerResponseCodes::Created;
+		OnComplete(MoveTemp(Response));
+		return true;
+	};
+
+	FHttpPath Path(TEXT("/api/v1/users/current/heartbeats.bulk"));
+#if ENGINE_MAJOR_VERSION >= 5 && ENGINE_MINOR_VERSION >= 4 // FHttpRequestHandler became a delegate in UE5.4
+	RouteHandle = Router->BindRoute(Path, EHttpServerRequestVerbs::VERB_POST, FHttpRequestHandler::CreateLambda(Handler));
+#else
+	RouteHandle = Router->BindRoute(Path, EHttpServerRequestVerbs::VERB_POST, Handler);
+#endif
+
+	FHttpServerModule::Get().StartAllListeners();
+
+	UE_LOG(LogWakaTimeRelay, Display, TEXT("Mock upstream listening on %s"), *GetUrl());
+	return true;
+}
+
+void FWakaTimeMockUpstream::Stop()
+{
+	if (!RouteHandle.IsValid())
+	{
+		return;
+	}
+
+	if (TSharedPtr<IHttpRouter> Router = FHttpServerModule::Get().GetHttpRouter(Port))
+	{
+		Router->UnbindRoute(RouteHandle);
+	}
+	RouteHandle.Reset();
+
+	UE_LOG(LogWakaTimeRelay, Display, TEXT("Mock upstream received %llu heartbeats in %llu requests"), NumHeartbeats,
+	       NumRequests);
+}
+
+FString FWakaTimeMockUpstream::GetUrl() const
+{
+	return FString::Printf(TEXT("http://127.0.0.1:%d/api/v1"), Port);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HttpRouteHandle.h"
+
+/// <summary>
+///	A stand-in for the wakatime api that only accepts bulk heartbeats and counts them.
+///	Started with -MockUpstreamPort, it lets the relay be exercised on localhost without a real server;
+///	-MockUpstreamFailEvery=N answers every Nth request with 503 to exercise the spool.
+/// </summary>
+class FWakaTimeMockUpstream
+{
+public:
+	/// <summary>
+	///	Binds the bulk route and starts the http listener
+	/// </summary>
+	bool Start(int32 InPort, int32 InFailEvery);
+
+	void Stop();
+
+	/// <summary>
+	///	Url to pass to the relay as its upstream
+	/// </summary>
+	FString GetUrl() const;
+
+private:
+	int32 Port = 0;
+	int32 FailEvery = 0;
+	uint64 NumRequests = 0;
+	uint64 NumHeartbeats = 0;
+	FHttpRouteHandle RouteHandle;
+};
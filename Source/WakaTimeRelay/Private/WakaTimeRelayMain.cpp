@@ -0,0 +1,96 @@
+#include "RequiredProgramMainCPPInclude.h"
+#include "WakaTimeRelayServer.h"
+#include "WakaTimeMockUpstream.h"
+#include "HttpModule.h"
+#include "HttpManager.h"
+#include "Containers/Ticker.h"
+
+IMPLEMENT_APPLICATION(WakaTimeRelay, "WakaTimeRelay");
+
+// How often the main loop wakes up; heartbeats are not latency sensitive
+static constexpr float GLoopIntervalSeconds = 0.05f;
+
+// How often the counters are written to the log
+static constexpr double GStatsIntervalSeconds = 300.0;
+
+/// <summary>
+///	Usage: WakaTimeRelay [-Port=9800] [-Bind=127.0.0.1] [-Secret=shared secret] [-Upstream=https://wakatime.studio.lan/api/v1]
+///	                     [-Spool=path] [-FlushInterval=10] [-MockUpstreamPort=9801 [-MockUpstreamFailEvery=N]]
+///	Listening on anything but the loopback interface requires -Secret.
+///	With -MockUpstreamPort and no -Upstream the relay forwards to the mock, so both run on localhost.
+/// </summary>
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	int32 Result = GEngineLoop.PreInit(ArgC, ArgV);
+	if (Result != 0)
+	{
+		return Result;
+	}
+
+	FWakaTimeRelaySettings Settings;
+	FParse::Value(FCommandLine::Get(), TEXT("-Port="), Settings.Port);
+	FParse::Value(FCommandLine::Get(), TEXT("-Bind="), Settings.BindAddress);
+	FParse::Value(FCommandLine::Get(), TEXT("-Secret="), Settings.Secret);
+	bool bHasUpstream = FParse::Value(FCommandLine::Get(), TEXT("-Upstream="), Settings.UpstreamUrl);
+	FParse::Value(FCommandLine::Get(), TEXT("-FlushInterval="), Settings.FlushIntervalSeconds);
+	Settings.SpoolPath = FPaths::Combine(FPlatformProcess::UserSettingsDir(), TEXT("WakaTimeRelay"), TEXT("spool.txt"));
+	FParse::Value(FCommandLine::Get(), TEXT("-Spool="), Settings.SpoolPath);
+	Settings.UpstreamUrl.RemoveFromEnd(TEXT("/"));
+
+	FWakaTimeMockUpstream MockUpstream;
+	int32 MockUpstreamPort = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("-MockUpstreamPort="), MockUpstreamPort))
+	{
+		int32 FailEvery = 0;
+		FParse::Value(FCommandLine::Get(), TEXT("-MockUpstreamFailEvery="), FailEvery);
+		if (!MockUpstream.Start(MockUpstreamPort, FailEvery))
+		{
+			return 1;
+		}
+
+		if (!bHasUpstream)
+		{
+			Settings.UpstreamUrl = MockUpstream.GetUrl();
+		}
+	}
+
+	FWakaTimeRelayServer Server(Settings);
+	if (!Server.Start())
+	{
+		return 1;
+	}
+
+	double LastTime = FPlatformTime::Seconds();
+	double LastStatsTime = LastTime;
+	while (!IsEngineExitRequested())
+	{
+		double Now = FPlatformTime::Seconds();
+		double DeltaTime = Now - LastTime;
+		LastTime = Now;
+
+#if ENGINE_MAJOR_VERSION >= 5
+		FTSTicker::GetCoreTicker().Tick(DeltaTime);
+#else // FTSTicker does not exist before UE5
+		FTicker::GetCoreTicker().Tick(DeltaTime);
+#endif
+		FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+		Server.Tick(DeltaTime);
+
+		if (Now - LastStatsTime >= GStatsIntervalSeconds)
+		{
+			Server.LogStats();
+			LastStatsTime = Now;
+		}
+
+		FPlatformProcess::Sleep(GLoopIntervalSeconds);
+	}
+
+	Server.Stop();
+	Server.LogStats();
+	MockUpstream.Stop();
+
+	FEngineLoop::AppPreExit();
+	FModuleManager::Get().UnloadModulesAtShutdown();
+	FEngineLoop::AppExit();
+	return 0;
+}
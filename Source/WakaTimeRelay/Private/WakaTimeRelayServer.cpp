@@ -0,0 +1,658 @@
+#include "WakaTimeRelayServer.h"
+
+#include "WakaTimeRelayProtocol.h"
+#include "Common/TcpListener.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Misc/Base64.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "HAL/PlatformFileManager.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+DEFINE_LOG_CATEGORY(LogWakaTimeRelay);
+
+// A non-write heartbeat this close to a waiting one with the same fields is dropped, the way the editor plugins
+// only send a heartbeat for the same file every two minutes
+static constexpr double GCoalesceWindowSeconds = 120.0;
+
+// The forwarded part at the start of the spool is cut off once it grows past this
+static constexpr int64 GSpoolCompactBytes = 16 * 1024 * 1024;
+
+// A line longer than this is not a record, the connection is dropped
+static constexpr int32 GMaxRecordLength = 16 * 1024;
+
+static std::vector<std::string> SplitRecord(const std::string& Record)
+{
+	std::vector<std::string> Fields;
+	size_t Start = 0;
+	while (true)
+	{
+		size_t End = Record.find(WakaTimeRelayProtocol::Separator, Start);
+		if (End == std::string::npos)
+		{
+			Fields.push_back(Record.substr(Start));
+			return Fields;
+		}
+		Fields.push_back(Record.substr(Start, End - Start));
+		Start = End + 1;
+	}
+}
+
+static FString ToFString(const std::string& Value)
+{
+	return FString(UTF8_TO_TCHAR(Value.c_str()));
+}
+
+FWakaTimeRelayServer::FWakaTimeRelayServer(const FWakaTimeRelaySettings& InSettings)
+	: Settings(InSettings)
+	, Secret(TCHAR_TO_UTF8(*InSettings.Secret))
+{
+}
+
+FWakaTimeRelayServer::~FWakaTimeRelayServer()
+{
+	Stop();
+}
+
+bool FWakaTimeRelayServer::Start()
+{
+	FIPv4Address BindAddress;
+	if (!FIPv4Address::Parse(Settings.BindAddress, BindAddress))
+	{
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Invalid bind address %s"), *Settings.BindAddress);
+		return false;
+	}
+
+	// anyone on the network could send heartbeats in someone else's name
+	if (Secret.empty() && BindAddress.A != 127)
+	{
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Refusing to listen on %s without -Secret"), *Settings.BindAddress);
+		return false;
+	}
+
+	FIPv4Endpoint Endpoint(BindAddress, Settings.Port);
+	Listener = new FTcpListener(Endpoint);
+	if (!Listener->IsActive())
+	{
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Could not listen on %s"), *Endpoint.ToString());
+		delete Listener;
+		Listener = nullptr;
+		return false;
+	}
+
+	Listener->OnConnectionAccepted().BindRaw(this, &FWakaTimeRelayServer::OnConnectionAccepted);
+
+	LoadSpool();
+
+	UE_LOG(LogWakaTimeRelay, Display, TEXT("Listening on %s, forwarding to %s, %d spooled batches"), *Endpoint.ToString(),
+	       *Settings.UpstreamUrl, SpoolLineCount);
+	return true;
+}
+
+void FWakaTimeRelayServer::Stop()
+{
+	if (Listener)
+	{
+		delete Listener; // joins the listener thread
+		Listener = nullptr;
+	}
+
+	TPair<FSocket*, FString> Accepted;
+	while (AcceptedSockets.Dequeue(Accepted))
+	{
+		Connections.push_back({Accepted.Key, Accepted.Value});
+	}
+
+	// whatever already arrived is still worth keeping
+	for (FRelayConnection& Connection : Connections)
+	{
+		ReadConnection(Connection);
+		Connection.Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Connection.Socket);
+	}
+	Connections.clear();
+
+	for (TPair<FString, FRelayBatch>& Pair : Batches)
+	{
+		FlushBatch(Pair.Value);
+	}
+	Batches.Empty();
+
+	if (bRequestInFlight && !bInFlightFromSpool)
+	{
+		AppendToSpool(InFlightPayload);
+	}
+	for (const FRelayPayload& Payload : Outbound)
+	{
+		AppendToSpool(Payload);
+	}
+	Outbound.clear();
+}
+
+bool FWakaTimeRelayServer::OnConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint)
+{
+	// listener thread; the socket is handed over to the main loop
+	Socket->SetNonBlocking(true);
+	AcceptedSockets.Enqueue(TPair<FSocket*, FString>(Socket, Endpoint.ToString()));
+	return true;
+}
+
+void FWakaTimeRelayServer::Tick(double DeltaTime)
+{
+	Clock += DeltaTime;
+
+	TPair<FSocket*, FString> Accepted;
+	while (AcceptedSockets.Dequeue(Accepted))
+	{
+		UE_LOG(LogWakaTimeRelay, Log, TEXT("Editor connected from %s"), *Accepted.Value);
+		Connections.push_back({Accepted.Key, Accepted.Value});
+		NumConnections++;
+
+		FRelayConnection& Connection = Connections.back();
+		Connection.Nonce = TCHAR_TO_UTF8(*FGuid::NewGuid().ToString(EGuidFormats::Digits));
+		std::string Challenge(1, WakaTimeRelayProtocol::ChallengeTag);
+		WakaTimeRelayProtocol::AppendField(Challenge, std::to_string(WakaTimeRelayProtocol::Version));
+		WakaTimeRelayProtocol::AppendField(Challenge, Connection.Nonce);
+		SendRecord(Connection, Challenge);
+	}
+
+	for (int32 Index = static_cast<int32>(Connections.size()) - 1; Index >= 0; Index--)
+	{
+		if (!ReadConnection(Connections[Index]))
+		{
+			UE_LOG(LogWakaTimeRelay, Log, TEXT("Editor %s disconnected"), *Connections[Index].Peer);
+			Connections[Index].Socket->Close();
+			ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Connections[Index].Socket);
+			Connections.erase(Connections.begin() + Index);
+		}
+	}
+
+	for (TPair<FString, FRelayBatch>& Pair : Batches)
+	{
+		FRelayBatch& Batch = Pair.Value;
+		if (!Batch.Heartbeats.empty() && Clock - Batch.OpenedAt >= Settings.FlushIntervalSeconds)
+		{
+			FlushBatch(Batch);
+		}
+	}
+
+	SendNextPayload();
+}
+
+bool FWakaTimeRelayServer::ReadConnection(FRelayConnection& Connection)
+{
+	uint8 Buffer[4096];
+	int32 BytesRead = 0;
+	uint32 PendingSize = 0;
+
+	while (Connection.Socket->HasPendingData(PendingSize) && PendingSize > 0)
+	{
+		if (!Connection.Socket->Recv(Buffer, sizeof(Buffer), BytesRead) || BytesRead <= 0)
+		{
+			return false;
+		}
+
+		Connection.ReadBuffer.append(reinterpret_cast<const char*>(Buffer), BytesRead);
+
+		size_t Start = 0;
+		size_t End;
+		while ((End = Connection.ReadBuffer.find(WakaTimeRelayProtocol::Terminator, Start)) != std::string::npos)
+		{
+			HandleRecord(Connection, Connection.ReadBuffer.substr(Start, End - Start));
+			Start = End + 1;
+			if (Connection.bRefused)
+			{
+				return false;
+			}
+		}
+		Connection.ReadBuffer.erase(0, Start);
+
+		if (Connection.ReadBuffer.size() > GMaxRecordLength)
+		{
+			UE_LOG(LogWakaTimeRelay, Warning, TEXT("Editor %s sent an overlong record"), *Connection.Peer);
+			return false;
+		}
+	}
+
+	// a socket that is readable without any data means the editor closed the connection
+	if (Connection.Socket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::Zero()) &&
+		!Connection.Socket->HasPendingData(PendingSize))
+	{
+		return false;
+	}
+
+	return Connection.Socket->GetConnectionState() != SCS_ConnectionError;
+}
+
+void FWakaTimeRelayServer::SendRecord(FRelayConnection& Connection, const std::string& Record)
+{
+	// the relay only sends two short records per connection, they fit into any socket buffer
+	std::string Line = Record + WakaTimeRelayProtocol::Terminator;
+	int32 BytesSent = 0;
+	Connection.Socket->Send(reinterpret_cast<const uint8*>(Line.data()), static_cast<int32>(Line.size()), BytesSent);
+}
+
+void FWakaTimeRelayServer::HandleHello(FRelayConnection& Connection, const std::vector<std::string>& Fields)
+{
+	// checked first, an older editor sends a different number of fields
+	if (Fields.size() < 2 || atoi(Fields[1].c_str()) != WakaTimeRelayProtocol::Version)
+	{
+		UE_LOG(LogWakaTimeRelay, Warning, TEXT("Refusing editor %s, it speaks protocol version %s"), *Connection.Peer,
+		       Fields.size() < 2 ? TEXT("?") : *ToFString(Fields[1]));
+		Connection.bRefused = true;
+		NumRefused++;
+		return;
+	}
+
+	if (Fields.size() != WakaTimeRelayProtocol::HelloFieldCount)
+	{
+		NumMalformed++;
+		Connection.bRefused = true;
+		return;
+	}
+
+	const std::string& Plugin = Fields[3];
+	const std::string& Machine = Fields[4];
+	const std::string& SealedKeyHex = Fields[5];
+	std::string Proof = WakaTimeRelayProtocol::ComputeProof(Secret, Connection.Nonce, Plugin, Machine, SealedKeyHex);
+
+	std::string SealedKey;
+	if (!WakaTimeRelayProtocol::ConstantTimeEquals(Proof, Fields[2]) ||
+		!WakaTimeRelayProtocol::FromHex(SealedKeyHex, SealedKey))
+	{
+		UE_LOG(LogWakaTimeRelay, Warning, TEXT("Refusing editor %s, it does not know the relay secret"), *Connection.Peer);
+		Connection.bRefused = true;
+		NumRefused++;
+		return;
+	}
+
+	std::string ApiKey = WakaTimeRelayProtocol::SealApiKey(Secret, Connection.Nonce, SealedKey);
+	Connection.BatchKey = ToFString(ApiKey + '\t' + Plugin + '\t' + Machine);
+	FRelayBatch& Batch = Batches.FindOrAdd(Connection.BatchKey);
+	Batch.ApiKey = ApiKey;
+	Batch.Plugin = Plugin;
+	Batch.Machine = Machine;
+
+	SendRecord(Connection, std::string(1, WakaTimeRelayProtocol::AcceptTag));
+}
+
+void FWakaTimeRelayServer::HandleRecord(FRelayConnection& Connection, const std::string& Record)
+{
+	if (!Record.empty() && Record.back() == '\r')
+	{
+		HandleRecord(Connection, Record.substr(0, Record.size() - 1));
+		return;
+	}
+
+	std::vector<std::string> Fields = SplitRecord(Record);
+	if (Fields.empty() || Fields[0].size() != 1)
+	{
+		NumMalformed++;
+		return;
+	}
+
+	if (Fields[0][0] == WakaTimeRelayProtocol::HelloTag && Connection.BatchKey.IsEmpty())
+	{
+		HandleHello(Connection, Fields);
+		return;
+	}
+
+	if (Fields[0][0] != WakaTimeRelayProtocol::HeartbeatTag || Fields.size() != WakaTimeRelayProtocol::HeartbeatFieldCount
+		|| Connection.BatchKey.IsEmpty())
+	{
+		NumMalformed++;
+		return;
+	}
+
+	FRelayHeartbeat Heartbeat;
+	Heartbeat.Time = atof(Fields[1].c_str());
+	Heartbeat.bIsWrite = Fields[2] == "1";
+	Heartbeat.Category = Fields[3];
+	Heartbeat.EntityType = Fields[4];
+	Heartbeat.Language = Fields[5];
+	Heartbeat.Project = Fields[6];
+	Heartbeat.Entity = Fields[7];
+
+	NumReceived++;
+	AddHeartbeat(Batches.FindOrAdd(Connection.BatchKey), Heartbeat);
+}
+
+void FWakaTimeRelayServer::AddHeartbeat(FRelayBatch& Batch, const FRelayHeartbeat& Heartbeat)
+{
+	if (!Heartbeat.bIsWrite)
+	{
+		for (FRelayHeartbeat& Existing : Batch.Heartbeats)
+		{
+			if (!Existing.bIsWrite && Existing.Entity == Heartbeat.Entity && Existing.Category == Heartbeat.Category &&
+				Existing.EntityType == Heartbeat.EntityType && Existing.Language == Heartbeat.Language &&
+				Existing.Project == Heartbeat.Project && FMath::Abs(Existing.Time - Heartbeat.Time) < GCoalesceWindowSeconds)
+			{
+				NumCoalesced++;
+				return;
+			}
+		}
+	}
+
+	if (Batch.Heartbeats.empty())
+	{
+		Batch.OpenedAt = Clock;
+	}
+	Batch.Heartbeats.push_back(Heartbeat);
+
+	if (static_cast<int32>(Batch.Heartbeats.size()) >= Settings.MaxBatchSize)
+	{
+		FlushBatch(Batch);
+	}
+}
+
+void FWakaTimeRelayServer::FlushBatch(FRelayBatch& Batch)
+{
+	if (Batch.Heartbeats.empty())
+	{
+		return;
+	}
+
+	FRelayPayload Payload;
+	Payload.ApiKey = Batch.ApiKey;
+	Payload.Plugin = Batch.Plugin;
+	Payload.Machine = Batch.Machine;
+	Payload.Count = static_cast<int32>(Batch.Heartbeats.size());
+
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer =
+		TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Payload.Json);
+	Writer->WriteArrayStart();
+	for (const FRelayHeartbeat& Heartbeat : Batch.Heartbeats)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("entity"), ToFString(Heartbeat.Entity));
+		Writer->WriteValue(TEXT("type"), ToFString(Heartbeat.EntityType));
+		Writer->WriteValue(TEXT("category"), ToFString(Heartbeat.Category));
+		Writer->WriteValue(TEXT("time"), Heartbeat.Time);
+		Writer->WriteValue(TEXT("is_write"), Heartbeat.bIsWrite);
+		Writer->WriteValue(TEXT("project"), ToFString(Heartbeat.Project));
+		Writer->WriteValue(TEXT("language"), ToFString(Heartbeat.Language));
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+	Writer->Close();
+
+	Batch.Heartbeats.clear();
+
+	// while the upstream is down new batches go straight to disk, so a crash of the relay loses nothing
+	if (SpoolLineCount > 0 || Clock < RetryAt)
+	{
+		AppendToSpool(Payload);
+	}
+	else
+	{
+		Outbound.push_back(Payload);
+	}
+}
+
+void FWakaTimeRelayServer::SendNextPayload()
+{
+	if (bRequestInFlight || Clock < RetryAt)
+	{
+		return;
+	}
+
+	// the spool holds the oldest heartbeats, it is drained first
+	if (SpoolLineCount > 0 && ReadSpoolHead(InFlightPayload))
+	{
+		bInFlightFromSpool = true;
+	}
+	else if (!Outbound.empty())
+	{
+		InFlightPayload = Outbound.front();
+		Outbound.pop_front();
+		bInFlightFromSpool = false;
+	}
+	else
+	{
+		return;
+	}
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Settings.UpstreamUrl + TEXT("/users/current/heartbeats.bulk"));
+	Request->SetVerb(TEXT("POST"));
+	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	Request->SetHeader(TEXT("Authorization"), TEXT("Basic ") + FBase64::Encode(ToFString(InFlightPayload.ApiKey)));
+	Request->SetHeader(TEXT("User-Agent"), TEXT("wakatime-relay/1 ") + ToFString(InFlightPayload.Plugin));
+	if (!InFlightPayload.Machine.empty())
+	{
+		Request->SetHeader(TEXT("X-Machine-Name"), ToFString(InFlightPayload.Machine));
+	}
+	Request->SetContentAsString(InFlightPayload.Json);
+	Request->OnProcessRequestComplete().BindRaw(this, &FWakaTimeRelayServer::OnUpstreamResponse);
+
+	bRequestInFlight = true;
+	NumRequests++;
+	Request->ProcessRequest();
+}
+
+void FWakaTimeRelayServer::OnUpstreamResponse(FHttpRequestPtr Request, FHttpResponsePtr Response,
+                                              bool bConnectedSuccessfully)
+{
+	bRequestInFlight = false;
+	int32 Code = Response.IsValid() ? Response->GetResponseCode() : 0;
+
+	if (bConnectedSuccessfully && Code >= 200 && Code < 300)
+	{
+		NumForwarded += InFlightPayload.Count;
+		UE_LOG(LogWakaTimeRelay, Log, TEXT("Forwarded %d heartbeats%s"), InFlightPayload.Count,
+		       bInFlightFromSpool ? TEXT(" from the spool") : TEXT(""));
+		if (bInFlightFromSpool)
+		{
+			RemoveSpoolHead();
+		}
+		return;
+	}
+
+	// a client error other than rate limiting will not go away by retrying (e.g. a revoked api key)
+	if (Code >= 400 && Code < 500 && Code != 429)
+	{
+		NumRejected += InFlightPayload.Count;
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Upstream rejected %d heartbeats with code %d, dropping them"),
+		       InFlightPayload.Count, Code);
+		if (bInFlightFromSpool)
+		{
+			RemoveSpoolHead();
+		}
+		return;
+	}
+
+	NumFailedRequests++;
+	RetryAt = Clock + Settings.RetrySeconds;
+	UE_LOG(LogWakaTimeRelay, Warning, TEXT("Upstream unavailable (code %d), retrying in %.0f s"), Code,
+	       Settings.RetrySeconds);
+
+	if (!bInFlightFromSpool)
+	{
+		AppendToSpool(InFlightPayload);
+	}
+
+	// everything queued in memory would fail the same way, keep it on disk instead
+	for (const FRelayPayload& Payload : Outbound)
+	{
+		AppendToSpool(Payload);
+	}
+	Outbound.clear();
+}
+
+void FWakaTimeRelayServer::AppendToSpool(const FRelayPayload& Payload)
+{
+	// one batch per line: nonce, sealed api key, plugin, machine, count, json (the condensed json contains no line breaks).
+	// The api key is sealed with the relay secret like on the wire, so the spool alone does not give the keys away
+	std::string Nonce = TCHAR_TO_UTF8(*FGuid::NewGuid().ToString(EGuidFormats::Digits));
+	std::string SealedKey = WakaTimeRelayProtocol::SealApiKey(Secret, Nonce, Payload.ApiKey);
+	FString Line = ToFString(Nonce) + TEXT("\t") +
+		ToFString(WakaTimeRelayProtocol::ToHex(reinterpret_cast<const uint8*>(SealedKey.data()), SealedKey.size())) +
+		TEXT("\t") + ToFString(Payload.Plugin) + TEXT("\t") + ToFString(Payload.Machine) + TEXT("\t") +
+		FString::FromInt(Payload.Count) + TEXT("\t") + Payload.Json + TEXT("\n");
+
+	if (FFileHelper::SaveStringToFile(Line, *Settings.SpoolPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+	                                  &IFileManager::Get(), FILEWRITE_Append))
+	{
+		SpoolLineCount++;
+		NumSpooled += Payload.Count;
+	}
+	else
+	{
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Could not write %d heartbeats to %s"), Payload.Count, *Settings.SpoolPath);
+	}
+}
+
+void FWakaTimeRelayServer::LoadSpool()
+{
+	SpoolLineCount = 0;
+	SpoolReadOffset = 0;
+
+	TArray<uint8> Spool;
+	if (!FFileHelper::LoadFileToArray(Spool, *Settings.SpoolPath, FILEREAD_Silent))
+	{
+		return;
+	}
+
+	FString Cursor;
+	if (FFileHelper::LoadFileToString(Cursor, *GetSpoolCursorPath()))
+	{
+		SpoolReadOffset = FCString::Atoi64(*Cursor);
+	}
+	if (SpoolReadOffset < 0 || SpoolReadOffset > Spool.Num())
+	{
+		UE_LOG(LogWakaTimeRelay, Warning, TEXT("Ignoring the spool cursor, it points outside of %s"), *Settings.SpoolPath);
+		SpoolReadOffset = 0;
+	}
+
+	// a batch cut off by a crash still counts as a line, it is skipped as corrupted when it is read
+	for (int64 Index = SpoolReadOffset; Index < Spool.Num(); Index++)
+	{
+		if (Spool[Index] == '\n' || Index == Spool.Num() - 1)
+		{
+			SpoolLineCount++;
+		}
+	}
+}
+
+bool FWakaTimeRelayServer::ReadSpoolHead(FRelayPayload& OutPayload)
+{
+	TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Settings.SpoolPath));
+	if (!File || SpoolReadOffset >= File->Size() || !File->Seek(SpoolReadOffset))
+	{
+		SpoolLineCount = 0;
+		return false;
+	}
+
+	// only the head line is read, the spool can hold days of batches
+	TArray<uint8> Line;
+	uint8 Chunk[4096];
+	int64 Remaining = File->Size() - SpoolReadOffset;
+	while (Remaining > 0)
+	{
+		int64 ChunkSize = FMath::Min<int64>(sizeof(Chunk), Remaining);
+		if (!File->Read(Chunk, ChunkSize))
+		{
+			break;
+		}
+		Remaining -= ChunkSize;
+
+		int32 LineEnd = 0;
+		while (LineEnd < ChunkSize && Chunk[LineEnd] != '\n')
+		{
+			LineEnd++;
+		}
+		Line.Append(Chunk, LineEnd < ChunkSize ? LineEnd + 1 : static_cast<int32>(ChunkSize));
+		if (LineEnd < ChunkSize)
+		{
+			break;
+		}
+	}
+	SpoolHeadLength = Line.Num();
+
+	int32 TextLength = Line.Num();
+	while (TextLength > 0 && (Line[TextLength - 1] == '\n' || Line[TextLength - 1] == '\r'))
+	{
+		TextLength--;
+	}
+	FUTF8ToTCHAR Text(reinterpret_cast<const ANSICHAR*>(Line.GetData()), TextLength);
+
+	TArray<FString> Fields;
+	FString(Text.Length(), Text.Get()).ParseIntoArray(Fields, TEXT("\t"), false);
+
+	// spools written before the keys were sealed hold five fields with the plain key
+	std::string ApiKey;
+	std::string SealedKey;
+	if (Fields.Num() == 6 && WakaTimeRelayProtocol::FromHex(TCHAR_TO_UTF8(*Fields[1]), SealedKey))
+	{
+		ApiKey = WakaTimeRelayProtocol::SealApiKey(Secret, TCHAR_TO_UTF8(*Fields[0]), SealedKey);
+		Fields.RemoveAt(0, 2);
+	}
+	else if (Fields.Num() == 5)
+	{
+		ApiKey = TCHAR_TO_UTF8(*Fields[0]);
+		Fields.RemoveAt(0);
+	}
+	else
+	{
+		UE_LOG(LogWakaTimeRelay, Error, TEXT("Skipping a corrupted spool line"));
+		RemoveSpoolHead();
+		return false;
+	}
+
+	OutPayload.ApiKey = ApiKey;
+	OutPayload.Plugin = TCHAR_TO_UTF8(*Fields[0]);
+	OutPayload.Machine = TCHAR_TO_UTF8(*Fields[1]);
+	OutPayload.Count = FCString::Atoi(*Fields[2]);
+	OutPayload.Json = Fields[3];
+	return true;
+}
+
+void FWakaTimeRelayServer::RemoveSpoolHead()
+{
+	// the head is only skipped over; rewriting the file for every forwarded batch would make draining quadratic
+	SpoolReadOffset += SpoolHeadLength;
+	SpoolHeadLength = 0;
+	SpoolLineCount = FMath::Max(SpoolLineCount - 1, 0);
+
+	if (SpoolLineCount == 0)
+	{
+		IFileManager::Get().Delete(*Settings.SpoolPath);
+		IFileManager::Get().Delete(*GetSpoolCursorPath());
+		SpoolReadOffset = 0;
+		return;
+	}
+
+	if (SpoolReadOffset >= GSpoolCompactBytes)
+	{
+		TArray<uint8> Spool;
+		if (FFileHelper::LoadFileToArray(Spool, *Settings.SpoolPath) && SpoolReadOffset <= Spool.Num())
+		{
+			Spool.RemoveAt(0, static_cast<int32>(SpoolReadOffset));
+			if (FFileHelper::SaveArrayToFile(Spool, *Settings.SpoolPath))
+			{
+				SpoolReadOffset = 0;
+			}
+		}
+	}
+
+	FFileHelper::SaveStringToFile(FString::Printf(TEXT("%lld"), SpoolReadOffset), *GetSpoolCursorPath());
+}
+
+FString FWakaTimeRelayServer::GetSpoolCursorPath() const
+{
+	return Settings.SpoolPath + TEXT(".cursor");
+}
+
+void FWakaTimeRelayServer::LogStats() const
+{
+	UE_LOG(LogWakaTimeRelay, Display,
+	       TEXT("%llu connections, %llu refused, %llu heartbeats received, %llu coalesced, %llu malformed, %llu forwarded in %llu requests, %llu failed requests, %llu rejected, %llu spooled"),
+	       NumConnections, NumRefused, NumReceived, NumCoalesced, NumMalformed, NumForwarded, NumRequests, NumFailedRequests,
+	       NumRejected, NumSpooled);
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Interfaces/IHttpRequest.h"
+
+class FSocket;
+class FTcpListener;
+struct FIPv4Endpoint;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogWakaTimeRelay, Log, All);
+
+/// <summary>
+///	Command line settings of the relay
+/// </summary>
+struct FWakaTimeRelaySettings
+{
+	/// <summary> Port the editors connect to </summary>
+	int32 Port = 9800;
+
+	/// <summary> Address of the interface to listen on; only this machine can connect unless it is changed </summary>
+	FString BindAddress = TEXT("127.0.0.1");
+
+	/// <summary> Shared with the editors (relay_secret in .wakatime.cfg); editors that cannot prove they know it are refused </summary>
+	FString Secret;
+
+	/// <summary> Base url of the wakatime api the heartbeats are forwarded to, e.g. https://wakatime.studio.lan/api/v1 </summary>
+	FString UpstreamUrl = TEXT("https://api.wakatime.com/api/v1");
+
+	/// <summary> File the batches are written to while the upstream is unreachable </summary>
+	FString SpoolPath;
+
+	/// <summary> How long heartbeats are collected before they are forwarded </summary>
+	double FlushIntervalSeconds = 10.0;
+
+	/// <summary> Heartbeats per bulk request; the wakatime api accepts at most 25 </summary>
+	int32 MaxBatchSize = 25;
+
+	/// <summary> How long to wait after a failed upstream request </summary>
+	double RetrySeconds = 30.0;
+};
+
+/// <summary>
+///	Accepts persistent connections from editors, coalesces their heartbeats, batches them per user
+///	and forwards them to the upstream api with the bulk endpoint. Batches that cannot be delivered are spooled on disk
+///	and retried once the upstream is back.
+/// </summary>
+class FWakaTimeRelayServer
+{
+public:
+	explicit FWakaTimeRelayServer(const FWakaTimeRelaySettings& InSettings);
+	~FWakaTimeRelayServer();
+
+	/// <summary>
+	///	Starts listening for editors
+	/// </summary>
+	/// <returns> False if the port could not be opened </returns>
+	bool Start();
+
+	/// <summary>
+	///	Spools everything that was not delivered yet and closes all connections
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	///	Reads from the connections, flushes due batches and drives the upstream requests. Called from the main loop
+	/// </summary>
+	void Tick(double DeltaTime);
+
+	/// <summary>
+	///	Writes the lifetime counters into the log
+	/// </summary>
+	void LogStats() const;
+
+private:
+	struct FRelayHeartbeat
+	{
+		double Time = 0.0;
+		bool bIsWrite = false;
+		std::string Category;
+		std::string EntityType;
+		std::string Language;
+		std::string Project;
+		std::string Entity;
+	};
+
+	/// <summary> Heartbeats of a single user, machine and plugin waiting to be forwarded </summary>
+	struct FRelayBatch
+	{
+		std::string ApiKey;
+		std::string Plugin;
+		std::string Machine;
+		std::vector<FRelayHeartbeat> Heartbeats;
+		double OpenedAt = 0.0;
+	};
+
+	/// <summary> A serialized bulk request </summary>
+	struct FRelayPayload
+	{
+		std::string ApiKey;
+		std::string Plugin;
+		std::string Machine;
+		int32 Count = 0;
+		FString Json;
+	};
+
+	struct FRelayConnection
+	{
+		FSocket* Socket = nullptr;
+		FString Peer;
+		std::string ReadBuffer;
+		FString BatchKey;
+
+		/// <summary> Sent in the challenge, the hello has to be signed with it </summary>
+		std::string Nonce;
+
+		/// <summary> The hello did not prove knowledge of the secret, the connection is closed </summary>
+		bool bRefused = false;
+	};
+
+	bool OnConnectionAccepted(FSocket* Socket, const FIPv4Endpoint& Endpoint);
+	bool ReadConnection(FRelayConnection& Connection);
+	void SendRecord(FRelayConnection& Connection, const std::string& Record);
+	void HandleHello(FRelayConnection& Connection, const std::vector<std::string>& Fields);
+	void HandleRecord(FRelayConnection& Connection, const std::string& Record);
+	void AddHeartbeat(FRelayBatch& Batch, const FRelayHeartbeat& Heartbeat);
+	void FlushBatch(FRelayBatch& Batch);
+	void SendNextPayload();
+	void OnUpstreamResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bConnectedSuccessfully);
+
+	void AppendToSpool(const FRelayPayload& Payload);
+	void LoadSpool();
+	bool ReadSpoolHead(FRelayPayload& OutPayload);
+	void RemoveSpoolHead();
+
+	/// <summary> Holds the read offset, so a restart does not forward the batches at the start of the spool again </summary>
+	FString GetSpoolCursorPath() const;
+
+	FWakaTimeRelaySettings Settings;
+	std::string Secret;
+	FTcpListener* Listener = nullptr;
+
+	/// <summary> Sockets accepted on the listener thread, picked up by the main loop </summary>
+	TQueue<TPair<FSocket*, FString>, EQueueMode::Mpsc> AcceptedSockets;
+
+	std::vector<FRelayConnection> Connections;
+
+	/// <summary> Keyed by api key, plugin and machine </summary>
+	TMap<FString, FRelayBatch> Batches;
+
+	std::deque<FRelayPayload> Outbound;
+
+	FRelayPayload InFlightPayload;
+	bool bRequestInFlight = false;
+	bool bInFlightFromSpool = false;
+	int32 SpoolLineCount = 0;
+
+	/// <summary> Start of the first batch in the spool not forwarded yet; everything before it is waiting to be cut off </summary>
+	int64 SpoolReadOffset = 0;
+
+	/// <summary> Length of the line last returned by ReadSpoolHead, including the line break </summary>
+	int64 SpoolHeadLength = 0;
+	double RetryAt = 0.0;
+	double Clock = 0.0;
+
+	// Lifetime counters
+	uint64 NumConnections = 0;
+	uint64 NumRefused = 0;
+	uint64 NumReceived = 0;
+	uint64 NumMalformed = 0;
+	uint64 NumCoalesced = 0;
+	uint64 NumForwarded = 0;
+	uint64 NumRequests = 0;
+	uint64 NumFailedRequests = 0;
+	uint64 NumRejected = 0;
+	uint64 NumSpooled = 0;
+};
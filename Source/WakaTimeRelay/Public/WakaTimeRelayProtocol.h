@@ -0,0 +1,157 @@
+#pragma once
+
+#include <string>
+
+#include "Misc/SecureHash.h"
+
+/// <summary>
+///	Wire format spoken between the editor plugin and WakaTimeRelay.
+///	Every record is a single line of tab separated UTF-8 fields, so a connection can be inspected with netcat:
+///
+///	C	version	nonce                                            (relay, right after accepting)
+///	H	version	proof	plugin	machine	sealed api key                (editor, answering the challenge)
+///	A                                                                (relay, the editor is authenticated)
+///	B	unix time	is write (0/1)	category	entity type	language	project	entity
+///
+///	Both sides share the relay secret. The proof is an HMAC of the nonce and the other hello fields keyed with the secret,
+///	so only editors that know the secret are accepted, and the api key travels XORed with a keystream derived from the secret
+///	and the nonce, so it never crosses the network in plaintext. The heartbeat records themselves are not encrypted.
+///	Heartbeats are only sent after the accept record. A record that is cut off by a dropped connection is discarded by
+///	the relay and sent again by the editor.
+/// </summary>
+namespace WakaTimeRelayProtocol
+{
+	static constexpr int32 Version = 2;
+
+	static constexpr int32 DefaultPort = 9800;
+
+	static constexpr char ChallengeTag = 'C';
+	static constexpr char HelloTag = 'H';
+	static constexpr char AcceptTag = 'A';
+	static constexpr char HeartbeatTag = 'B';
+	static constexpr char Separator = '\t';
+	static constexpr char Terminator = '\n';
+
+	/// <summary> Number of fields of a challenge record, including the tag </summary>
+	static constexpr int32 ChallengeFieldCount = 3;
+
+	/// <summary> Number of fields of a hello record, including the tag </summary>
+	static constexpr int32 HelloFieldCount = 6;
+
+	/// <summary> Number of fields of a heartbeat record, including the tag </summary>
+	static constexpr int32 HeartbeatFieldCount = 8;
+
+	/// <summary>
+	///	Appends a field, replacing the characters that would break the record apart
+	/// </summary>
+	inline void AppendField(std::string& Record, const std::string& Field)
+	{
+		Record += Separator;
+		for (char Character : Field)
+		{
+			Record += (Character == Separator || Character == Terminator || Character == '\r') ? ' ' : Character;
+		}
+	}
+
+	inline std::string ToHex(const uint8* Bytes, size_t Count)
+	{
+		static const char Digits[] = "0123456789abcdef";
+		std::string Hex;
+		Hex.reserve(Count * 2);
+		for (size_t Index = 0; Index < Count; Index++)
+		{
+			Hex += Digits[Bytes[Index] >> 4];
+			Hex += Digits[Bytes[Index] & 0xf];
+		}
+		return Hex;
+	}
+
+	/// <returns> False if the text is not an even number of hex digits </returns>
+	inline bool FromHex(const std::string& Hex, std::string& OutBytes)
+	{
+		if (Hex.size() % 2 != 0)
+		{
+			return false;
+		}
+
+		OutBytes.clear();
+		for (size_t Index = 0; Index < Hex.size(); Index += 2)
+		{
+			int32 Byte = 0;
+			for (size_t Digit = Index; Digit < Index + 2; Digit++)
+			{
+				char Character = Hex[Digit];
+				int32 Value = Character >= '0' && Character <= '9' ? Character - '0'
+					: Character >= 'a' && Character <= 'f' ? Character - 'a' + 10
+					: Character >= 'A' && Character <= 'F' ? Character - 'A' + 10
+					: -1;
+				if (Value < 0)
+				{
+					return false;
+				}
+				Byte = Byte * 16 + Value;
+			}
+			OutBytes += static_cast<char>(Byte);
+		}
+		return true;
+	}
+
+	inline std::string Hmac(const std::string& Secret, const std::string& Message)
+	{
+		uint8 Hash[FSHA1::DigestSize];
+		FSHA1::HMACBuffer(Secret.data(), static_cast<uint32>(Secret.size()), Message.data(), Message.size(), Hash);
+		return std::string(reinterpret_cast<const char*>(Hash), FSHA1::DigestSize);
+	}
+
+	/// <summary>
+	///	XORs the api key with a keystream of HMAC(secret, nonce, block index) blocks; sealing and opening are the same operation.
+	///	The nonce is new for every connection, so the keystream is never reused
+	/// </summary>
+	inline std::string SealApiKey(const std::string& Secret, const std::string& Nonce, const std::string& ApiKey)
+	{
+		std::string Sealed = ApiKey;
+		std::string Block;
+		for (size_t Index = 0; Index < Sealed.size(); Index++)
+		{
+			if (Index % FSHA1::DigestSize == 0)
+			{
+				Block = Hmac(Secret, "key" + std::string(1, Separator) + Nonce + Separator + std::to_string(Index / FSHA1::DigestSize));
+			}
+			Sealed[Index] ^= Block[Index % FSHA1::DigestSize];
+		}
+		return Sealed;
+	}
+
+	/// <summary>
+	///	Proof of knowing the secret, covering the nonce and every other field of the hello
+	/// </summary>
+	inline std::string ComputeProof(const std::string& Secret, const std::string& Nonce, const std::string& Plugin,
+	                                const std::string& Machine, const std::string& SealedKeyHex)
+	{
+		std::string Message = "hello";
+		AppendField(Message, Nonce);
+		AppendField(Message, Plugin);
+		AppendField(Message, Machine);
+		AppendField(Message, SealedKeyHex);
+		std::string Proof = Hmac(Secret, Message);
+		return ToHex(reinterpret_cast<const uint8*>(Proof.data()), Proof.size());
+	}
+
+	/// <summary>
+	///	Compares without returning early, so the time taken does not tell how much of a proof was right
+	/// </summary>
+	inline bool ConstantTimeEquals(const std::string& A, const std::string& B)
+	{
+		if (A.size() != B.size())
+		{
+			return false;
+		}
+
+		uint8 Difference = 0;
+		for (size_t Index = 0; Index < A.size(); Index++)
+		{
+			Difference |= static_cast<uint8>(A[Index] ^ B[Index]);
+		}
+		return Difference == 0;
+	}
+}
@@ -0,0 +1,29 @@
+using System.IO;
+using UnrealBuildTool;
+
+public class WakaTimeRelay : ModuleRules
+{
+	public WakaTimeRelay(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicIncludePaths.Add(Path.Combine(EngineDirectory, "Source/Runtime/Launch/Public"));
+
+		PrivateIncludePaths.Add(Path.Combine(EngineDirectory, "Source/Runtime/Launch/Private"));
+
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"ApplicationCore",
+				"Projects",
+				"Sockets",
+				"Networking",
+				"HTTP",
+				"HTTPServer",
+				"Json"
+			}
+			);
+	}
+}
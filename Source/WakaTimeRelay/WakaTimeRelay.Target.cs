@@ -0,0 +1,22 @@
+using UnrealBuildTool;
+
+[SupportedPlatforms(UnrealPlatformClass.Desktop)]
+public class WakaTimeRelayTarget : TargetRules
+{
+	public WakaTimeRelayTarget(TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		LaunchModuleName = "WakaTimeRelay";
+
+		// The relay is a small headless server, it needs neither the engine nor UObjects
+		bBuildDeveloperTools = false;
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = true;
+		bCompileICU = false;
+		bBuildWithEditorOnlyData = false;
+		bUseLoggingInShipping = true;
+		bIsBuildingConsoleApplication = true;
+	}
+}